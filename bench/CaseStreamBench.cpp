@@ -0,0 +1,120 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+// Times the single element functions on a stream where every call uses the same case
+// number and on a stream where the case number changes randomly from call to call
+// (ex. many sensors mounted in different frames).  With the table driven functions
+// the two times should be about the same.
+//
+// Build from the repository root, for example:
+//   g++ -O2 -std=c++11 -I. bench/CaseStreamBench.cpp changeOfBasis.cpp changeOfBasisKernels.cpp changeOfBasisSimd.cpp -o caseStreamBench
+
+#include "changeOfBasis.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace cob;
+
+static const size_t STREAM_LENGTH = 1 << 20;
+static const int REPEATS = 20;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// Returns nanoseconds per call and adds the results into sink so nothing is optimized away.
+template <typename Op>
+static double timeStream( const std::vector<int> &cases, Op op, double &sink )
+{
+	double best = 1e30;
+
+	for (int r = 0; r < REPEATS; ++r)
+	{
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < cases.size(); ++i)
+		{
+			sink += op( cases[i], static_cast<double>(i) );
+		}
+		double ns = std::chrono::duration<double, std::nano>( Clock::now() - start ).count();
+		if (ns < best) best = ns;
+	}
+
+	return best / static_cast<double>(cases.size());
+}
+
+static double vectorOp( int caseNumber, double x )
+{
+	double vx(x), vy(2.0), vz(3.0);
+	vectorCob( caseNumber, vx, vy, vz );
+	return vx + vy + vz;
+}
+
+static double quatOp( int caseNumber, double x )
+{
+	double qx(x), qy(2.0), qz(3.0), qw(4.0);
+	quatCob( caseNumber, qx, qy, qz, qw );
+	return qx + qy + qz + qw;
+}
+
+static double matrixOp( int caseNumber, double x )
+{
+	double m00(x), m01(2.0), m02(3.0);
+	double m10(4.0), m11(5.0), m12(6.0);
+	double m20(7.0), m21(8.0), m22(9.0);
+	matrixCob3x3( caseNumber, m00, m01, m02, m10, m11, m12, m20, m21, m22 );
+	return m00 + m01 + m02 + m10 + m11 + m12 + m20 + m21 + m22;
+}
+
+static double aToBOp( int caseNumber, double x )
+{
+	double m00, m01, m02;
+	double m10, m11, m12;
+	double m20, m21, m22;
+	getAtoBMatrix( caseNumber, m00, m01, m02, m10, m11, m12, m20, m21, m22 );
+	return x * (m00 + m11 + m22);
+}
+
+template <typename Op>
+static void report( const char *name, Op op, const std::vector<int> &fixedCases, const std::vector<int> &randomCases, double &sink )
+{
+	double fixedNs = timeStream( fixedCases, op, sink );
+	double randomNs = timeStream( randomCases, op, sink );
+
+	std::cout << name << "\tfixed " << fixedNs << " ns\trandom " << randomNs
+		<< " ns\trandom/fixed " << randomNs / fixedNs << std::endl;
+}
+
+int main()
+{
+	std::vector<int> fixedCases( STREAM_LENGTH, 16 );
+	std::vector<int> randomCases( STREAM_LENGTH );
+
+	std::mt19937 rng( 12345 );
+	std::uniform_int_distribution<int> anyCase( 0, 47 );
+	for (size_t i = 0; i < randomCases.size(); ++i)
+	{
+		randomCases[i] = anyCase( rng );
+	}
+
+	double sink = 0.0;
+
+	report( "vectorCob", vectorOp, fixedCases, randomCases, sink );
+	report( "quatCob", quatOp, fixedCases, randomCases, sink );
+	report( "matrixCob3x3", matrixOp, fixedCases, randomCases, sink );
+	report( "getAtoBMatrix", aToBOp, fixedCases, randomCases, sink );
+
+	std::cout << "(checksum " << sink << ")" << std::endl;
+	return 0;
+}
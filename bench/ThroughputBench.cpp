@@ -0,0 +1,520 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+// Times vectorCob, quatCob, matrixCob3x3, eulerCob, matrixCob4x4 and IMU samples over arrays
+// sized to sit in L1, L2, the last level cache and DRAM.  Each one is timed calling the single element function
+// with a fixed case number and with a random case number per element, and calling the
+// batch function in place and out of place.  The mixed batch functions are timed with a
+// random case number per element, with runs of one case number and in place.  Matrices are also timed through the full
+// math  mAtoB * mA * transpose(mAtoB)  with ColumnMatrix3d from the test project so the
+// speedup can be seen and regressions caught.  The parallel batch functions are timed
+// on the arrays too big for L2, and on the largest arrays again with the memory placed on
+// each NUMA node in turn and interleaved over all of them to show the bandwidth per node.
+// The strided functions are timed on a field in 64 and 128 byte structs, and vectors are
+// timed between packed and separate x, y, z arrays.
+// A chain of three conversions is timed as three batch passes and as a LazyArray
+// materialized once.
+// cobCopy is timed against memcpy on its own and memcpy followed by a conversion in place.
+//
+// Prints one line per timing: function, data size, variant, ns per element and GB/s
+// (bytes read plus bytes written).  Pass "quick" to skip the DRAM sized arrays.
+//
+// Build from the repository root, for example:
+//   g++ -O2 -std=c++11 -I. -Imsvc/ChangeOfBasisTests bench/ThroughputBench.cpp changeOfBasis.cpp changeOfBasisKernels.cpp changeOfBasisLazy.cpp changeOfBasisParallel.cpp changeOfBasisPlan.cpp changeOfBasisSimd.cpp msvc/ChangeOfBasisTests/Math.cpp -pthread -o throughputBench
+
+#include "changeOfBasis.h"
+#include "changeOfBasisLazy.h"
+#include "changeOfBasisParallel.h"
+#include "changeOfBasisPlan.h"
+#include "Math.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace cob;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct DataSize
+{
+	const char *name;
+	size_t bytes;		// size of the source array
+};
+
+static const DataSize dataSizes[] =
+{
+	{ "L1", 16 * 1024 },
+	{ "L2", 256 * 1024 },
+	{ "LLC", 8 * 1024 * 1024 },
+	{ "DRAM", 256 * 1024 * 1024 }
+};
+
+static const int FIXED_CASE = 16;
+
+// Every timing processes at least this many elements in total and keeps the best pass.
+static const size_t MIN_ELEMENTS = 1 << 24;
+static const int MIN_PASSES = 3;
+
+// Returns the best nanoseconds per element over several passes.
+template <typename Op>
+static double timePasses( size_t count, Op op )
+{
+	int passes = static_cast<int>(MIN_ELEMENTS / count);
+	if (passes < MIN_PASSES) passes = MIN_PASSES;
+
+	double best = 1e30;
+	for (int r = 0; r < passes; ++r)
+	{
+		Clock::time_point start = Clock::now();
+		op();
+		double ns = std::chrono::duration<double, std::nano>( Clock::now() - start ).count();
+		if (ns < best) best = ns;
+	}
+
+	return best / static_cast<double>(count);
+}
+
+static void report( const char *function, const DataSize &size, const char *variant, double ns, int lanes )
+{
+	// Every element is read once and written once
+	const double bytes = 2.0 * lanes * sizeof(double);
+
+	std::cout << std::left << std::setw( 16 ) << function
+		<< std::setw( 6 ) << size.name
+		<< std::setw( 18 ) << variant
+		<< std::right << std::fixed << std::setprecision( 3 )
+		<< std::setw( 10 ) << ns << " ns"
+		<< std::setw( 10 ) << std::setprecision( 2 ) << bytes / ns << " GB/s" << std::endl;
+}
+
+// One element of each kind through the single element functions
+static void vectorElement( int caseNumber, double *v )
+{
+	vectorCob( caseNumber, v[0], v[1], v[2] );
+}
+
+static void quatElement( int caseNumber, double *q )
+{
+	quatCob( caseNumber, q[0], q[1], q[2], q[3] );
+}
+
+static void matrixElement( int caseNumber, double *m )
+{
+	matrixCob3x3( caseNumber, m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8] );
+}
+
+// The Euler functions take an Euler case number, which only has 8 values
+static void eulerElement( int caseNumber, double *e )
+{
+	eulerCob( caseNumber & 7, e[0], e[1], e[2] );
+}
+
+static void quatBatch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	quatCobBatch( caseNumber, QUAT_XYZW, src, dst, count );
+}
+
+static void eulerBatch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	eulerCobBatch( caseNumber & 7, src, dst, count );
+}
+
+static void transformElement( int caseNumber, double *m )
+{
+	matrixCob4x4( caseNumber, m );
+}
+
+// One packed IMU sample through the field functions
+static void imuElement( int caseNumber, double *s )
+{
+	vectorCob( caseNumber, s[0], s[1], s[2] );
+	pseudoVectorCob( caseNumber, s[3], s[4], s[5] );
+	pseudoVectorCob( caseNumber, s[6], s[7], s[8] );
+	quatCob( caseNumber, s[9], s[10], s[11], s[12] );
+}
+
+static void imuBatch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	ImuCob cob;
+	getImuCob( caseNumber, ImuPackedLayout, cob );
+	imuCobBatch( cob, src, dst, count );
+}
+
+typedef void (*MixedBatchFn)( const int *, const double *, double *, size_t );
+
+static void quatMixed( const int *caseNumbers, const double *src, double *dst, size_t count )
+{
+	quatCobBatchMixed( caseNumbers, QUAT_XYZW, src, dst, count );
+}
+
+static void benchMixed( const char *function, int lanes, MixedBatchFn batch, const DataSize &size,
+	const std::vector<int> &randomCases )
+{
+	const size_t count = size.bytes / (lanes * sizeof(double));
+
+	std::vector<double> src( count * lanes );
+	std::vector<double> dst( count * lanes );
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+
+	// The same cases in runs of 1000 elements
+	std::vector<int> runCases( count );
+	for (size_t n = 0; n < count; ++n) runCases[n] = randomCases[n / 1000];
+
+	const double *s = &src[0];
+	double *d = &dst[0];
+	const int *random = &randomCases[0];
+	const int *runs = &runCases[0];
+
+	report( function, size, "mixed random", timePasses( count, [=]()
+	{
+		batch( random, s, d, count );
+	} ), lanes );
+
+	report( function, size, "mixed runs", timePasses( count, [=]()
+	{
+		batch( runs, s, d, count );
+	} ), lanes );
+
+	report( function, size, "mixed in place", timePasses( count, [=]()
+	{
+		batch( random, d, d, count );
+	} ), lanes );
+}
+
+static void vectorParallel( int caseNumber, const double *src, double *dst, size_t count )
+{
+	vectorCobBatchParallel( caseNumber, src, dst, count );
+}
+
+static void matrixParallel( int caseNumber, const double *src, double *dst, size_t count )
+{
+	matrixCob3x3BatchParallel( caseNumber, src, dst, count );
+}
+
+static void benchParallel( const char *function, int lanes, void (*batch)( int, const double *, double *, size_t ),
+	const DataSize &size )
+{
+	const size_t count = size.bytes / (lanes * sizeof(double));
+
+	std::vector<double> src( count * lanes );
+	std::vector<double> dst( count * lanes );
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+	std::memcpy( &dst[0], &src[0], src.size() * sizeof(double) );
+
+	double *s = &src[0];
+	double *d = &dst[0];
+
+	report( function, size, "parallel in place", timePasses( count, [=]()
+	{
+		batch( FIXED_CASE, d, d, count );
+	} ), lanes );
+
+	report( function, size, "parallel out place", timePasses( count, [=]()
+	{
+		batch( FIXED_CASE, s, d, count );
+	} ), lanes );
+}
+
+// Both arrays on one node, or interleaved over all of them
+static void benchNuma( const char *function, int lanes, void (*batch)( int, const double *, double *, size_t ),
+	const DataSize &size, int node )
+{
+	const size_t count = size.bytes / (lanes * sizeof(double));
+	const size_t bytes = count * lanes * sizeof(double);
+
+	double *s = static_cast<double *>(allocateOnNode( bytes, node ));
+	double *d = static_cast<double *>(allocateOnNode( bytes, node ));
+	if (s == NULL || d == NULL)
+	{
+		freeOnNode( s, bytes );
+		freeOnNode( d, bytes );
+		return;
+	}
+	for (size_t i = 0; i < count * lanes; ++i)
+	{
+		s[i] = d[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+
+	char variant[32];
+	if (node == NUMA_INTERLEAVE) std::snprintf( variant, sizeof(variant), "interleaved" );
+	else std::snprintf( variant, sizeof(variant), "node %d", node );
+
+	report( function, size, variant, timePasses( count, [=]()
+	{
+		batch( FIXED_CASE, s, d, count );
+	} ), lanes );
+
+	freeOnNode( s, bytes );
+	freeOnNode( d, bytes );
+}
+
+// The field at the start of structs of structLanes doubles, converted where it is and
+// gathered into a packed array
+static void benchStrided( const char *function, int lanes, int structLanes,
+	void (*strided)( int, const double *, size_t, double *, size_t, size_t ), const DataSize &size )
+{
+	const size_t count = size.bytes / (structLanes * sizeof(double));
+	const size_t stride = structLanes * sizeof(double);
+
+	std::vector<double> structs( count * structLanes );
+	std::vector<double> packed( count * lanes );
+	for (size_t i = 0; i < structs.size(); ++i)
+	{
+		structs[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+
+	double *s = &structs[0];
+	double *d = &packed[0];
+
+	report( function, size, "strided in place", timePasses( count, [=]()
+	{
+		strided( FIXED_CASE, s, stride, s, stride, count );
+	} ), lanes );
+
+	report( function, size, "strided to packed", timePasses( count, [=]()
+	{
+		strided( FIXED_CASE, s, stride, d, lanes * sizeof(double), count );
+	} ), lanes );
+}
+
+// Vectors between packed and x[], y[], z[] arrays, and converted as arrays
+static void benchSoA( const DataSize &size )
+{
+	const size_t count = size.bytes / (3 * sizeof(double));
+
+	std::vector<double> packed( count * 3 );
+	std::vector<double> components( count * 3 );
+	for (size_t i = 0; i < packed.size(); ++i)
+	{
+		packed[i] = components[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+
+	const double *s = &packed[0];
+	double *d = &packed[0];
+	double *x = &components[0];
+	double *y = x + count;
+	double *z = y + count;
+
+	report( "vectorCob", size, "AoS to SoA", timePasses( count, [=]()
+	{
+		vectorCobAoSToSoA( FIXED_CASE, s, x, y, z, count );
+	} ), 3 );
+
+	report( "vectorCob", size, "SoA to AoS", timePasses( count, [=]()
+	{
+		vectorCobSoAToAoS( FIXED_CASE, x, y, z, d, count );
+	} ), 3 );
+
+	// Only the arrays that change sign are touched.  FIXED_CASE only swaps x and y and case 1
+	// only negates z.
+	report( "vectorCob", size, "SoA swap", timePasses( count, [=]()
+	{
+		double *px = x, *py = y, *pz = z;
+		vectorCobSoA( FIXED_CASE, px, py, pz, count );
+	} ), 3 );
+
+	report( "vectorCob", size, "SoA one sign", timePasses( count, [=]()
+	{
+		double *px = x, *py = y, *pz = z;
+		vectorCobSoA( 1, px, py, pz, count );
+	} ), 3 );
+}
+
+// Three conversions in a row, as three batch passes and as one LazyArray pass
+static void benchLazy( const DataSize &size )
+{
+	const size_t count = size.bytes / (3 * sizeof(double));
+
+	std::vector<double> values( count * 3 );
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		values[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+	double *v = &values[0];
+
+	report( "vectorCob", size, "3 passes", timePasses( count, [=]()
+	{
+		vectorCobBatch( getCaseNumber( 5, 17 ), v, count );
+		vectorCobBatch( getCaseNumber( 17, 30 ), v, count );
+		vectorCobBatch( getCaseNumber( 30, 46 ), v, count );
+	} ), 3 );
+
+	report( "vectorCob", size, "lazy 3 to 1", timePasses( count, [=]()
+	{
+		LazyArray<double> lazy( v, count, ELEMENT_VECTOR, 0, 5 );
+		lazy.retarget( 17 );
+		lazy.retarget( 30 );
+		lazy.retarget( 46 );
+		lazy.materialize();
+	} ), 3 );
+}
+
+// memcpy() and then the batch function in place, against cobCopy() doing both in one pass
+static void benchCopy( const char *function, int lanes, int element, const DataSize &size )
+{
+	const size_t count = size.bytes / (lanes * sizeof(double));
+
+	std::vector<double> src( count * lanes );
+	std::vector<double> dst( count * lanes );
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+
+	double *s = &src[0];
+	double *d = &dst[0];
+
+	report( function, size, "memcpy", timePasses( count, [=]()
+	{
+		std::memcpy( d, s, count * lanes * sizeof(double) );
+	} ), lanes );
+
+	report( function, size, "memcpy then cob", timePasses( count, [=]()
+	{
+		std::memcpy( d, s, count * lanes * sizeof(double) );
+		cobCopy( element, 0, FIXED_CASE, d, d, count );
+	} ), lanes );
+
+	report( function, size, "cobCopy", timePasses( count, [=]()
+	{
+		cobCopy( element, 0, FIXED_CASE, s, d, count );
+	} ), lanes );
+}
+
+template <typename Element, typename Batch>
+static void benchFunction( const char *function, int lanes, Element element, Batch batch, bool fullMath,
+	const DataSize &size, const std::vector<int> &randomCases )
+{
+	const size_t count = size.bytes / (lanes * sizeof(double));
+
+	std::vector<double> src( count * lanes );
+	std::vector<double> dst( count * lanes );
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = 0.25 * static_cast<double>((i % 97) + 1);
+	}
+	std::memcpy( &dst[0], &src[0], src.size() * sizeof(double) );
+
+	double *s = &src[0];
+	double *d = &dst[0];
+	const int *cases = &randomCases[0];
+
+	report( function, size, "single fixed", timePasses( count, [=]()
+	{
+		for (size_t n = 0; n < count; ++n) element( FIXED_CASE, d + n * lanes );
+	} ), lanes );
+
+	report( function, size, "single random", timePasses( count, [=]()
+	{
+		for (size_t n = 0; n < count; ++n) element( cases[n], d + n * lanes );
+	} ), lanes );
+
+	report( function, size, "batch in place", timePasses( count, [=]()
+	{
+		batch( FIXED_CASE, d, d, count );
+	} ), lanes );
+
+	report( function, size, "batch out place", timePasses( count, [=]()
+	{
+		batch( FIXED_CASE, s, d, count );
+	} ), lanes );
+
+	if (fullMath)
+	{
+		ColumnMatrix3d mAtoB;
+		getAtoBMatrix( FIXED_CASE,
+			mAtoB._m[0][0], mAtoB._m[0][1], mAtoB._m[0][2],
+			mAtoB._m[1][0], mAtoB._m[1][1], mAtoB._m[1][2],
+			mAtoB._m[2][0], mAtoB._m[2][1], mAtoB._m[2][2] );
+		const ColumnMatrix3d mAtoBTranspose = mAtoB.transpose();
+
+		report( function, size, "full math", timePasses( count, [=]()
+		{
+			for (size_t n = 0; n < count; ++n)
+			{
+				ColumnMatrix3d mA;
+				std::memcpy( mA._m, s + n * 9, sizeof(mA._m) );
+				const ColumnMatrix3d mB = mAtoB * mA * mAtoBTranspose;
+				std::memcpy( d + n * 9, mB._m, sizeof(mB._m) );
+			}
+		} ), lanes );
+	}
+}
+
+int main( int argc, char **argv )
+{
+	const bool quick = (argc > 1 && std::strcmp( argv[1], "quick" ) == 0);
+	const int sizeCount = static_cast<int>(sizeof(dataSizes) / sizeof(dataSizes[0])) - (quick ? 1 : 0);
+
+	const char *levelNames[] = { "none", "AVX2", "AVX-512" };
+	std::cout << "SIMD level: " << levelNames[getSimdLevel()] << ", threads: " << getParallelThreads()
+		<< ", NUMA nodes: " << getParallelNumaNodes() << std::endl;
+
+	// Enough random case numbers for the largest array of vectors
+	const size_t maxCount = dataSizes[sizeCount - 1].bytes / (3 * sizeof(double));
+	std::vector<int> randomCases( maxCount );
+	std::mt19937 rng( 12345 );
+	std::uniform_int_distribution<int> anyCase( 0, 47 );
+	for (size_t i = 0; i < randomCases.size(); ++i)
+	{
+		randomCases[i] = anyCase( rng );
+	}
+
+	for (int i = 0; i < sizeCount; ++i)
+	{
+		benchFunction( "vectorCob", 3, vectorElement, static_cast<void (*)( int, const double *, double *, size_t )>( vectorCobBatch ), false, dataSizes[i], randomCases );
+		benchFunction( "quatCob", 4, quatElement, quatBatch, false, dataSizes[i], randomCases );
+		benchFunction( "matrixCob3x3", 9, matrixElement, static_cast<void (*)( int, const double *, double *, size_t )>( matrixCob3x3Batch ), true, dataSizes[i], randomCases );
+		benchFunction( "eulerCob", 3, eulerElement, eulerBatch, false, dataSizes[i], randomCases );
+		benchFunction( "matrixCob4x4", 16, transformElement, static_cast<void (*)( int, const double *, double *, size_t )>( matrixCob4x4Batch ), false, dataSizes[i], randomCases );
+		benchFunction( "imuCobBatch", 13, imuElement, imuBatch, false, dataSizes[i], randomCases );
+		benchMixed( "vectorCob", 3, vectorCobBatchMixed, dataSizes[i], randomCases );
+		benchMixed( "quatCob", 4, quatMixed, dataSizes[i], randomCases );
+		benchMixed( "matrixCob3x3", 9, matrixCob3x3BatchMixed, dataSizes[i], randomCases );
+	}
+
+	for (int i = 2; i < sizeCount; ++i)
+	{
+		benchParallel( "vectorCob", 3, vectorParallel, dataSizes[i] );
+		benchParallel( "matrixCob3x3", 9, matrixParallel, dataSizes[i] );
+	}
+
+	for (int i = 0; i < sizeCount; ++i)
+	{
+		benchStrided( "vectorCob", 3, 8, vectorCobBatchStrided, dataSizes[i] );
+		benchSoA( dataSizes[i] );
+		benchLazy( dataSizes[i] );
+		benchStrided( "matrixCob3x3", 9, 16, matrixCob3x3BatchStrided, dataSizes[i] );
+		benchCopy( "vectorCob", 3, ELEMENT_VECTOR, dataSizes[i] );
+		benchCopy( "matrixCob3x3", 9, ELEMENT_MATRIX3X3, dataSizes[i] );
+	}
+
+	for (int node = NUMA_INTERLEAVE; node < getParallelNumaNodes(); ++node)
+	{
+		benchNuma( "vectorCob", 3, vectorParallel, dataSizes[sizeCount - 1], node );
+	}
+
+	return 0;
+}
@@ -12,7 +12,9 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
-#include "ChangeOfBasis.h"
+#include "changeOfBasis.h"
+#include "changeOfBasisInline.h"
+#include "changeOfBasisKernels.h"
 
 namespace cob
 {
@@ -106,783 +108,971 @@ int getCaseNumber( const triple &from, const triple &to)
 	return p * 8 + s;
 }
 
+FrameId getFrameId( const triple &frame )
+{
+	return inlined::getFrameId( frame );
+}
+
+triple getFrameFromId( FrameId id )
+{
+	return inlined::getFrameFromId( id );
+}
+
+int getCaseNumber( FrameId from, FrameId to )
+{
+	return inlined::getCaseNumber( from, to );
+}
+
+int getEulerCaseNumber( FrameId from, FrameId to )
+{
+	return inlined::getEulerCaseNumber( from, to );
+}
+
+int composeCase( int caseAtoB, int caseBtoC )
+{
+	return inlined::composeCase( caseAtoB, caseBtoC );
+}
+
+int inverseCase( int caseNumber )
+{
+	return inlined::inverseCase( caseNumber );
+}
+
+bool isReflection( int caseNumber )
+{
+	return inlined::isReflection( caseNumber );
+}
+
+bool isIdentity( int caseNumber )
+{
+	return inlined::isIdentity( caseNumber );
+}
+
+// The change of basis is done with table lookups instead of a switch so the cost is the same
+// no matter which case number is used or how often it changes between calls.  The tables
+// and the math are in changeOfBasisInline.h.
 void matrixCob3x3(int caseNumber, 
 	double &a00, double &a01, double &a02,
 	double &a10, double &a11, double &a12,
 	double &a20, double &a21, double &a22)
 {
-	double m00, m01, m02;
-	double m10, m11, m12;
-	double m20, m21, m22;
-
-	m00 = a00;  m01 = a01; m02 = a02;
-	m10 = a10;  m11 = a11; m12 = a12;
-	m20 = a20;  m21 = a21; m22 = a22;
+	inlined::matrixCob3x3( caseNumber, a00, a01, a02, a10, a11, a12, a20, a21, a22 );
+}
 
-	switch(caseNumber)
-	{
-		case 0 :
-			a00 =  m00; a01 =  m01; a02 =  m02;
-			a10 =  m10; a11 =  m11; a12 =  m12;
-			a20 =  m20; a21 =  m21; a22 =  m22;
-			break;
-		case 1 :
-			a00 =  m00; a01 =  m01; a02 = -m02;
-			a10 =  m10; a11 =  m11; a12 = -m12;
-			a20 = -m20; a21 = -m21; a22 =  m22;
-			break;
-		case 2 :
-			a00 =  m00; a01 = -m01; a02 =  m02;
-			a10 = -m10; a11 =  m11; a12 = -m12;
-			a20 =  m20; a21 = -m21; a22 =  m22;
-			break;
-		case 3 :
-			a00 =  m00; a01 = -m01; a02 = -m02;
-			a10 = -m10; a11 =  m11; a12 =  m12;
-			a20 = -m20; a21 =  m21; a22 =  m22;
-			break;
-		case 4 :
-			a00 =  m00; a01 = -m01; a02 = -m02;
-			a10 = -m10; a11 =  m11; a12 =  m12;
-			a20 = -m20; a21 =  m21; a22 =  m22;
-			break;
-		case 5 :
-			a00 =  m00; a01 = -m01; a02 =  m02;
-			a10 = -m10; a11 =  m11; a12 = -m12;
-			a20 =  m20; a21 = -m21; a22 =  m22;
-			break;
-		case 6 :
-			a00 =  m00; a01 =  m01; a02 = -m02;
-			a10 =  m10; a11 =  m11; a12 = -m12;
-			a20 = -m20; a21 = -m21; a22 =  m22;
-			break;
-		case 7 :
-			a00 =  m00; a01 =  m01; a02 =  m02;
-			a10 =  m10; a11 =  m11; a12 =  m12;
-			a20 =  m20; a21 =  m21; a22 =  m22;
-			break;
-		case 8 :
-			a00 =  m00; a01 =  m02; a02 =  m01;
-			a10 =  m20; a11 =  m22; a12 =  m21;
-			a20 =  m10; a21 =  m12; a22 =  m11;
-			break;
-		case 9 :
-			a00 =  m00; a01 = -m02; a02 =  m01;
-			a10 = -m20; a11 =  m22; a12 = -m21;
-			a20 =  m10; a21 = -m12; a22 =  m11;
-			break;
-		case 10 :
-			a00 =  m00; a01 =  m02; a02 = -m01;
-			a10 =  m20; a11 =  m22; a12 = -m21;
-			a20 = -m10; a21 = -m12; a22 =  m11;
-			break;
-		case 11 :
-			a00 =  m00; a01 = -m02; a02 = -m01;
-			a10 = -m20; a11 =  m22; a12 =  m21;
-			a20 = -m10; a21 =  m12; a22 =  m11;
-			break;
-		case 12 :
-			a00 =  m00; a01 = -m02; a02 = -m01;
-			a10 = -m20; a11 =  m22; a12 =  m21;
-			a20 = -m10; a21 =  m12; a22 =  m11;
-			break;
-		case 13 :
-			a00 =  m00; a01 =  m02; a02 = -m01;
-			a10 =  m20; a11 =  m22; a12 = -m21;
-			a20 = -m10; a21 = -m12; a22 =  m11;
-			break;
-		case 14 :
-			a00 =  m00; a01 = -m02; a02 =  m01;
-			a10 = -m20; a11 =  m22; a12 = -m21;
-			a20 =  m10; a21 = -m12; a22 =  m11;
-			break;
-		case 15 :
-			a00 =  m00; a01 =  m02; a02 =  m01;
-			a10 =  m20; a11 =  m22; a12 =  m21;
-			a20 =  m10; a21 =  m12; a22 =  m11;
-			break;
-		case 16 :
-			a00 =  m11; a01 =  m10; a02 =  m12;
-			a10 =  m01; a11 =  m00; a12 =  m02;
-			a20 =  m21; a21 =  m20; a22 =  m22;
-			break;
-		case 17 :
-			a00 =  m11; a01 =  m10; a02 = -m12;
-			a10 =  m01; a11 =  m00; a12 = -m02;
-			a20 = -m21; a21 = -m20; a22 =  m22;
-			break;
-		case 18 :
-			a00 =  m11; a01 = -m10; a02 = -m12;
-			a10 = -m01; a11 =  m00; a12 =  m02;
-			a20 = -m21; a21 =  m20; a22 =  m22;
-			break;
-		case 19 :
-			a00 =  m11; a01 = -m10; a02 =  m12;
-			a10 = -m01; a11 =  m00; a12 = -m02;
-			a20 =  m21; a21 = -m20; a22 =  m22;
-			break;
-		case 20 :
-			a00 =  m11; a01 = -m10; a02 =  m12;
-			a10 = -m01; a11 =  m00; a12 = -m02;
-			a20 =  m21; a21 = -m20; a22 =  m22;
-			break;
-		case 21 :
-			a00 =  m11; a01 = -m10; a02 = -m12;
-			a10 = -m01; a11 =  m00; a12 =  m02;
-			a20 = -m21; a21 =  m20; a22 =  m22;
-			break;
-		case 22 :
-			a00 =  m11; a01 =  m10; a02 = -m12;
-			a10 =  m01; a11 =  m00; a12 = -m02;
-			a20 = -m21; a21 = -m20; a22 =  m22;
-			break;
-		case 23 :
-			a00 =  m11; a01 =  m10; a02 =  m12;
-			a10 =  m01; a11 =  m00; a12 =  m02;
-			a20 =  m21; a21 =  m20; a22 =  m22;
-			break;
-		case 24 :
-			a00 =  m22; a01 =  m20; a02 =  m21;
-			a10 =  m02; a11 =  m00; a12 =  m01;
-			a20 =  m12; a21 =  m10; a22 =  m11;
-			break;
-		case 25 :
-			a00 =  m22; a01 = -m20; a02 = -m21;
-			a10 = -m02; a11 =  m00; a12 =  m01;
-			a20 = -m12; a21 =  m10; a22 =  m11;
-			break;
-		case 26 :
-			a00 =  m22; a01 =  m20; a02 = -m21;
-			a10 =  m02; a11 =  m00; a12 = -m01;
-			a20 = -m12; a21 = -m10; a22 =  m11;
-			break;
-		case 27 :
-			a00 =  m22; a01 = -m20; a02 =  m21;
-			a10 = -m02; a11 =  m00; a12 = -m01;
-			a20 =  m12; a21 = -m10; a22 =  m11;
-			break;
-		case 28 :
-			a00 =  m22; a01 = -m20; a02 =  m21;
-			a10 = -m02; a11 =  m00; a12 = -m01;
-			a20 =  m12; a21 = -m10; a22 =  m11;
-			break;
-		case 29 :
-			a00 =  m22; a01 =  m20; a02 = -m21;
-			a10 =  m02; a11 =  m00; a12 = -m01;
-			a20 = -m12; a21 = -m10; a22 =  m11;
-			break;
-		case 30 :
-			a00 =  m22; a01 = -m20; a02 = -m21;
-			a10 = -m02; a11 =  m00; a12 =  m01;
-			a20 = -m12; a21 =  m10; a22 =  m11;
-			break;
-		case 31 :
-			a00 =  m22; a01 =  m20; a02 =  m21;
-			a10 =  m02; a11 =  m00; a12 =  m01;
-			a20 =  m12; a21 =  m10; a22 =  m11;
-			break;
-		case 32 :
-			a00 =  m11; a01 =  m12; a02 =  m10;
-			a10 =  m21; a11 =  m22; a12 =  m20;
-			a20 =  m01; a21 =  m02; a22 =  m00;
-			break;
-		case 33 :
-			a00 =  m11; a01 = -m12; a02 =  m10;
-			a10 = -m21; a11 =  m22; a12 = -m20;
-			a20 =  m01; a21 = -m02; a22 =  m00;
-			break;
-		case 34 :
-			a00 =  m11; a01 = -m12; a02 = -m10;
-			a10 = -m21; a11 =  m22; a12 =  m20;
-			a20 = -m01; a21 =  m02; a22 =  m00;
-			break;
-		case 35 :
-			a00 =  m11; a01 =  m12; a02 = -m10;
-			a10 =  m21; a11 =  m22; a12 = -m20;
-			a20 = -m01; a21 = -m02; a22 =  m00;
-			break;
-		case 36 :
-			a00 =  m11; a01 =  m12; a02 = -m10;
-			a10 =  m21; a11 =  m22; a12 = -m20;
-			a20 = -m01; a21 = -m02; a22 =  m00;
-			break;
-		case 37 :
-			a00 =  m11; a01 = -m12; a02 = -m10;
-			a10 = -m21; a11 =  m22; a12 =  m20;
-			a20 = -m01; a21 =  m02; a22 =  m00;
-			break;
-		case 38 :
-			a00 =  m11; a01 = -m12; a02 =  m10;
-			a10 = -m21; a11 =  m22; a12 = -m20;
-			a20 =  m01; a21 = -m02; a22 =  m00;
-			break;
-		case 39 :
-			a00 =  m11; a01 =  m12; a02 =  m10;
-			a10 =  m21; a11 =  m22; a12 =  m20;
-			a20 =  m01; a21 =  m02; a22 =  m00;
-			break;
-		case 40 :
-			a00 =  m22; a01 =  m21; a02 =  m20;
-			a10 =  m12; a11 =  m11; a12 =  m10;
-			a20 =  m02; a21 =  m01; a22 =  m00;
-			break;
-		case 41 :
-			a00 =  m22; a01 = -m21; a02 = -m20;
-			a10 = -m12; a11 =  m11; a12 =  m10;
-			a20 = -m02; a21 =  m01; a22 =  m00;
-			break;
-		case 42 :
-			a00 =  m22; a01 = -m21; a02 =  m20;
-			a10 = -m12; a11 =  m11; a12 = -m10;
-			a20 =  m02; a21 = -m01; a22 =  m00;
-			break;
-		case 43 :
-			a00 =  m22; a01 =  m21; a02 = -m20;
-			a10 =  m12; a11 =  m11; a12 = -m10;
-			a20 = -m02; a21 = -m01; a22 =  m00;
-			break;
-		case 44 :
-			a00 =  m22; a01 =  m21; a02 = -m20;
-			a10 =  m12; a11 =  m11; a12 = -m10;
-			a20 = -m02; a21 = -m01; a22 =  m00;
-			break;
-		case 45 :
-			a00 =  m22; a01 = -m21; a02 =  m20;
-			a10 = -m12; a11 =  m11; a12 = -m10;
-			a20 =  m02; a21 = -m01; a22 =  m00;
-			break;
-		case 46 :
-			a00 =  m22; a01 = -m21; a02 = -m20;
-			a10 = -m12; a11 =  m11; a12 =  m10;
-			a20 = -m02; a21 =  m01; a22 =  m00;
-			break;
-		case 47 :
-			a00 =  m22; a01 =  m21; a02 =  m20;
-			a10 =  m12; a11 =  m11; a12 =  m10;
-			a20 =  m02; a21 =  m01; a22 =  m00;
-			break;
-	}
+void matrixCob3x3(int caseNumber, 
+	float &a00, float &a01, float &a02,
+	float &a10, float &a11, float &a12,
+	float &a20, float &a21, float &a22)
+{
+	inlined::matrixCob3x3( caseNumber, a00, a01, a02, a10, a11, a12, a20, a21, a22 );
 }
 
+// MAtoB[k][ index[k] ] = sign(negate[k]) and every other element is zero.
 void getAtoBMatrix(int caseNumber, 
 	double &m00, double &m01, double &m02,
 	double &m10, double &m11, double &m12,
 	double &m20, double &m21, double &m22)
 {
-	switch(caseNumber)
+	if (!detail::validCase( caseNumber )) return;
+
+	const detail::CaseDescriptor &d = detail::caseTable[caseNumber];
+
+	double m[3][3] =
 	{
-		case 0 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 1 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 2 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 3 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 4 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 5 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 6 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 7 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 8 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 9 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 10 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 11 :
-			m00 = 1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 12 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 13 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 14 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 15 :
-			m00 = -1.0; m01 = 0.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 16 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 17 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 18 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 19 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 20 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 21 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 22 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = 1.0;
-			break;
-		case 23 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 0.0; m22 = -1.0;
-			break;
-		case 24 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 25 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 26 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 27 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = 1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 28 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 29 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = 1.0; m22 = 0.0;
-			break;
-		case 30 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 31 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = -1.0; m11 = 0.0; m12 = 0.0;
-			m20 = 0.0; m21 = -1.0; m22 = 0.0;
-			break;
-		case 32 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 33 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 34 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 35 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 36 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 37 :
-			m00 = 0.0; m01 = 1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 38 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = 1.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 39 :
-			m00 = 0.0; m01 = -1.0; m02 = 0.0;
-			m10 = 0.0; m11 = 0.0; m12 = -1.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 40 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 41 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 42 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 43 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = 1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 44 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 45 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = 0.0; m11 = 1.0; m12 = 0.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 46 :
-			m00 = 0.0; m01 = 0.0; m02 = 1.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-		case 47 :
-			m00 = 0.0; m01 = 0.0; m02 = -1.0;
-			m10 = 0.0; m11 = -1.0; m12 = 0.0;
-			m20 = -1.0; m21 = 0.0; m22 = 0.0;
-			break;
-	}
+		{ 0.0, 0.0, 0.0 },
+		{ 0.0, 0.0, 0.0 },
+		{ 0.0, 0.0, 0.0 }
+	};
+
+	m[0][d.index[0]] = detail::signOf<double>( d.negate[0] );
+	m[1][d.index[1]] = detail::signOf<double>( d.negate[1] );
+	m[2][d.index[2]] = detail::signOf<double>( d.negate[2] );
+
+	m00 = m[0][0]; m01 = m[0][1]; m02 = m[0][2];
+	m10 = m[1][0]; m11 = m[1][1]; m12 = m[1][2];
+	m20 = m[2][0]; m21 = m[2][1]; m22 = m[2][2];
 }
 
-void quatCob( int caseNumber, double &qx, double &qy, double &qz, double & /* qw */ )
+void quatCob( int caseNumber, double &qx, double &qy, double &qz, double &qw )
 {
-	double tx, ty, tz;
-	tx = qx; ty = qy; tz = qz;
+	inlined::quatCob( caseNumber, qx, qy, qz, qw );
+}
 
-	switch(caseNumber)
-	{
-		case 0:   qx =  tx; qy =  ty; qz =  tz;  break;
-		case 1:   qx = -tx; qy = -ty; qz =  tz;  break;
-		case 2:   qx = -tx; qy =  ty; qz = -tz;  break;
-		case 3:   qx =  tx; qy = -ty; qz = -tz;  break;
-		case 4:   qx =  tx; qy = -ty; qz = -tz;  break;
-		case 5:   qx = -tx; qy =  ty; qz = -tz;  break;
-		case 6:   qx = -tx; qy = -ty; qz =  tz;  break;
-		case 7:   qx =  tx; qy =  ty; qz =  tz;  break;
-		case 8:   qx = -tx; qy = -tz; qz = -ty;  break;
-		case 9:   qx =  tx; qy = -tz; qz =  ty;  break;
-		case 10:   qx =  tx; qy =  tz; qz = -ty;  break;
-		case 11:   qx = -tx; qy =  tz; qz =  ty;  break;
-		case 12:   qx = -tx; qy =  tz; qz =  ty;  break;
-		case 13:   qx =  tx; qy =  tz; qz = -ty;  break;
-		case 14:   qx =  tx; qy = -tz; qz =  ty;  break;
-		case 15:   qx = -tx; qy = -tz; qz = -ty;  break;
-		case 16:   qx = -ty; qy = -tx; qz = -tz;  break;
-		case 17:   qx =  ty; qy =  tx; qz = -tz;  break;
-		case 18:   qx = -ty; qy =  tx; qz =  tz;  break;
-		case 19:   qx =  ty; qy = -tx; qz =  tz;  break;
-		case 20:   qx =  ty; qy = -tx; qz =  tz;  break;
-		case 21:   qx = -ty; qy =  tx; qz =  tz;  break;
-		case 22:   qx =  ty; qy =  tx; qz = -tz;  break;
-		case 23:   qx = -ty; qy = -tx; qz = -tz;  break;
-		case 24:   qx =  tz; qy =  tx; qz =  ty;  break;
-		case 25:   qx =  tz; qy = -tx; qz = -ty;  break;
-		case 26:   qx = -tz; qy = -tx; qz =  ty;  break;
-		case 27:   qx = -tz; qy =  tx; qz = -ty;  break;
-		case 28:   qx = -tz; qy =  tx; qz = -ty;  break;
-		case 29:   qx = -tz; qy = -tx; qz =  ty;  break;
-		case 30:   qx =  tz; qy = -tx; qz = -ty;  break;
-		case 31:   qx =  tz; qy =  tx; qz =  ty;  break;
-		case 32:   qx =  ty; qy =  tz; qz =  tx;  break;
-		case 33:   qx = -ty; qy =  tz; qz = -tx;  break;
-		case 34:   qx =  ty; qy = -tz; qz = -tx;  break;
-		case 35:   qx = -ty; qy = -tz; qz =  tx;  break;
-		case 36:   qx = -ty; qy = -tz; qz =  tx;  break;
-		case 37:   qx =  ty; qy = -tz; qz = -tx;  break;
-		case 38:   qx = -ty; qy =  tz; qz = -tx;  break;
-		case 39:   qx =  ty; qy =  tz; qz =  tx;  break;
-		case 40:   qx = -tz; qy = -ty; qz = -tx;  break;
-		case 41:   qx = -tz; qy =  ty; qz =  tx;  break;
-		case 42:   qx =  tz; qy = -ty; qz =  tx;  break;
-		case 43:   qx =  tz; qy =  ty; qz = -tx;  break;
-		case 44:   qx =  tz; qy =  ty; qz = -tx;  break;
-		case 45:   qx =  tz; qy = -ty; qz =  tx;  break;
-		case 46:   qx = -tz; qy =  ty; qz =  tx;  break;
-		case 47:   qx = -tz; qy = -ty; qz = -tx;  break;
-	}
+void quatCob( int caseNumber, float &qx, float &qy, float &qz, float &qw )
+{
+	inlined::quatCob( caseNumber, qx, qy, qz, qw );
 }
 
 void vectorCob( int caseNumber, double &vx, double &vy, double &vz )
 {
-	double tx, ty, tz;
-	tx = vx; ty = vy; tz = vz;
+	inlined::vectorCob( caseNumber, vx, vy, vz );
+}
+
+void vectorCob( int caseNumber, float &vx, float &vy, float &vz )
+{
+	inlined::vectorCob( caseNumber, vx, vy, vz );
+}
+
+void pseudoVectorCob( int caseNumber, double &vx, double &vy, double &vz )
+{
+	inlined::pseudoVectorCob( caseNumber, vx, vy, vz );
+}
+
+void pseudoVectorCob( int caseNumber, float &vx, float &vy, float &vz )
+{
+	inlined::pseudoVectorCob( caseNumber, vx, vy, vz );
+}
+
+void pseudoVectorCobBatch( int caseNumber, double *v, size_t count )
+{
+	pseudoVectorCobBatch( caseNumber, v, v, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getPseudoVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, float *v, size_t count )
+{
+	pseudoVectorCobBatch( caseNumber, v, v, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getPseudoVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, int16_t *v, size_t count )
+{
+	pseudoVectorCobBatch( caseNumber, v, v, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getPseudoVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, int32_t *v, size_t count )
+{
+	pseudoVectorCobBatch( caseNumber, v, v, count );
+}
+
+void pseudoVectorCobBatch( int caseNumber, const int32_t *src, int32_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getPseudoVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob4x4( int caseNumber, double *m )
+{
+	inlined::matrixCob4x4( caseNumber, m );
+}
+
+void matrixCob3x4( int caseNumber, int layout, double *m )
+{
+	inlined::matrixCob3x4( caseNumber, layout, m );
+}
+
+void matrixCob4x4( int caseNumber, float *m )
+{
+	inlined::matrixCob4x4( caseNumber, m );
+}
+
+void matrixCob3x4( int caseNumber, int layout, float *m )
+{
+	inlined::matrixCob3x4( caseNumber, layout, m );
+}
+
+void matrixCob4x4Batch( int caseNumber, double *m, size_t count )
+{
+	matrixCob4x4Batch( caseNumber, m, m, count );
+}
+
+void matrixCob4x4Batch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrix4x4Permutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x4Batch( int caseNumber, int layout, double *m, size_t count )
+{
+	matrixCob3x4Batch( caseNumber, layout, m, m, count );
+}
+
+void matrixCob3x4Batch( int caseNumber, int layout, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrix3x4Permutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob4x4Batch( int caseNumber, float *m, size_t count )
+{
+	matrixCob4x4Batch( caseNumber, m, m, count );
+}
+
+void matrixCob4x4Batch( int caseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrix4x4Permutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x4Batch( int caseNumber, int layout, float *m, size_t count )
+{
+	matrixCob3x4Batch( caseNumber, layout, m, m, count );
+}
+
+void matrixCob3x4Batch( int caseNumber, int layout, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrix3x4Permutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void vectorCobBatch( int caseNumber, double *v, size_t count )
+{
+	vectorCobBatch( caseNumber, v, v, count );
+}
+
+void vectorCobBatch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void vectorCobBatch( int caseNumber, float *v, size_t count )
+{
+	vectorCobBatch( caseNumber, v, v, count );
+}
+
+void vectorCobBatch( int caseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, double *q, size_t count )
+{
+	quatCobBatch( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, float *q, size_t count )
+{
+	quatCobBatch( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, double *m, size_t count )
+{
+	matrixCob3x3Batch( caseNumber, m, m, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, double *m, size_t count )
+{
+	matrixCob3x3Batch( caseNumber, inLayout, outLayout, m, m, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, inLayout, outLayout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, float *m, size_t count )
+{
+	matrixCob3x3Batch( caseNumber, m, m, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, float *m, size_t count )
+{
+	matrixCob3x3Batch( caseNumber, inLayout, outLayout, m, m, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, inLayout, outLayout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+// The Euler case numbers are worked out by the compiler into the frame pair table in
+// changeOfBasisInline.h so this is only two frame ids and a table read.
+int getEulerCaseNumber( const triple &from,	const triple &to)
+{
+	return inlined::getEulerCaseNumber( from, to );
+}
+
+void eulerCob( int eulerCaseNumber, double &yaw, double &pitch, double &roll)
+{
+	inlined::eulerCob( eulerCaseNumber, yaw, pitch, roll );
+}
+
+void eulerCob( int eulerCaseNumber, float &yaw, float &pitch, float &roll)
+{
+	inlined::eulerCob( eulerCaseNumber, yaw, pitch, roll );
+}
+
+void eulerCob( const triple &fromFrame, const triple &toFrame, double &yaw, double &pitch, double &roll )
+{
+	inlined::eulerCob( inlined::getEulerCaseNumber( fromFrame, toFrame ), yaw, pitch, roll );
+}
+
+void eulerCobBatch( int eulerCaseNumber, double *angles, size_t count )
+{
+	eulerCobBatch( eulerCaseNumber, angles, angles, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getEulerPermutation( eulerCaseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, float *angles, size_t count )
+{
+	eulerCobBatch( eulerCaseNumber, angles, angles, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getEulerPermutation( eulerCaseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void vectorCobBatchMixed( const int *caseNumbers, double *v, size_t count )
+{
+	vectorCobBatchMixed( caseNumbers, v, v, count );
+}
+
+void vectorCobBatchMixed( const int *caseNumbers, const double *src, double *dst, size_t count )
+{
+	detail::permuteMixed( detail::getVectorMixed(), caseNumbers, src, dst, count );
+}
+
+void vectorCobBatchMixed( const int *caseNumbers, float *v, size_t count )
+{
+	vectorCobBatchMixed( caseNumbers, v, v, count );
+}
+
+void vectorCobBatchMixed( const int *caseNumbers, const float *src, float *dst, size_t count )
+{
+	detail::permuteMixed( detail::getVectorMixed(), caseNumbers, src, dst, count );
+}
+
+void quatCobBatchMixed( const int *caseNumbers, int layout, double *q, size_t count )
+{
+	quatCobBatchMixed( caseNumbers, layout, q, q, count );
+}
+
+void quatCobBatchMixed( const int *caseNumbers, int layout, const double *src, double *dst, size_t count )
+{
+	detail::permuteMixed( detail::getQuatMixed( layout ), caseNumbers, src, dst, count );
+}
+
+void quatCobBatchMixed( const int *caseNumbers, int layout, float *q, size_t count )
+{
+	quatCobBatchMixed( caseNumbers, layout, q, q, count );
+}
+
+void quatCobBatchMixed( const int *caseNumbers, int layout, const float *src, float *dst, size_t count )
+{
+	detail::permuteMixed( detail::getQuatMixed( layout ), caseNumbers, src, dst, count );
+}
+
+void matrixCob3x3BatchMixed( const int *caseNumbers, double *m, size_t count )
+{
+	matrixCob3x3BatchMixed( caseNumbers, m, m, count );
+}
+
+void matrixCob3x3BatchMixed( const int *caseNumbers, const double *src, double *dst, size_t count )
+{
+	detail::permuteMixed( detail::getMatrixMixed(), caseNumbers, src, dst, count );
+}
+
+void matrixCob3x3BatchMixed( const int *caseNumbers, float *m, size_t count )
+{
+	matrixCob3x3BatchMixed( caseNumbers, m, m, count );
+}
+
+void matrixCob3x3BatchMixed( const int *caseNumbers, const float *src, float *dst, size_t count )
+{
+	detail::permuteMixed( detail::getMatrixMixed(), caseNumbers, src, dst, count );
+}
+
+void vectorCobBatchStrided( int caseNumber, double *v, size_t stride, size_t count )
+{
+	vectorCobBatchStrided( caseNumber, v, stride, v, stride, count );
+}
+
+void vectorCobBatchStrided( int caseNumber, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteStrided( p, src, srcStride, dst, dstStride, count );
+}
 
-	switch(caseNumber)
+void vectorCobBatchStrided( int caseNumber, float *v, size_t stride, size_t count )
+{
+	vectorCobBatchStrided( caseNumber, v, stride, v, stride, count );
+}
+
+void vectorCobBatchStrided( int caseNumber, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteStrided( p, src, srcStride, dst, dstStride, count );
+}
+
+void quatCobBatchStrided( int caseNumber, int layout, double *q, size_t stride, size_t count )
+{
+	quatCobBatchStrided( caseNumber, layout, q, stride, q, stride, count );
+}
+
+void quatCobBatchStrided( int caseNumber, int layout, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteStrided( p, src, srcStride, dst, dstStride, count );
+}
+
+void quatCobBatchStrided( int caseNumber, int layout, float *q, size_t stride, size_t count )
+{
+	quatCobBatchStrided( caseNumber, layout, q, stride, q, stride, count );
+}
+
+void quatCobBatchStrided( int caseNumber, int layout, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteStrided( p, src, srcStride, dst, dstStride, count );
+}
+
+void matrixCob3x3BatchStrided( int caseNumber, double *m, size_t stride, size_t count )
+{
+	matrixCob3x3BatchStrided( caseNumber, m, stride, m, stride, count );
+}
+
+void matrixCob3x3BatchStrided( int caseNumber, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteStrided( p, src, srcStride, dst, dstStride, count );
+}
+
+void matrixCob3x3BatchStrided( int caseNumber, float *m, size_t stride, size_t count )
+{
+	matrixCob3x3BatchStrided( caseNumber, m, stride, m, stride, count );
+}
+
+void matrixCob3x3BatchStrided( int caseNumber, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteStrided( p, src, srcStride, dst, dstStride, count );
+}
+
+void vectorCobSoA( int caseNumber, double *&x, double *&y, double *&z, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	double *arrays[3] = { x, y, z };
+	detail::permuteSoA( p, arrays, count );
+	x = arrays[0];
+	y = arrays[1];
+	z = arrays[2];
+}
+
+void vectorCobSoA( int caseNumber, float *&x, float *&y, float *&z, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	float *arrays[3] = { x, y, z };
+	detail::permuteSoA( p, arrays, count );
+	x = arrays[0];
+	y = arrays[1];
+	z = arrays[2];
+}
+
+void pseudoVectorCobSoA( int caseNumber, double *&x, double *&y, double *&z, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getPseudoVectorPermutation( caseNumber, p );
+	double *arrays[3] = { x, y, z };
+	detail::permuteSoA( p, arrays, count );
+	x = arrays[0];
+	y = arrays[1];
+	z = arrays[2];
+}
+
+void pseudoVectorCobSoA( int caseNumber, float *&x, float *&y, float *&z, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getPseudoVectorPermutation( caseNumber, p );
+	float *arrays[3] = { x, y, z };
+	detail::permuteSoA( p, arrays, count );
+	x = arrays[0];
+	y = arrays[1];
+	z = arrays[2];
+}
+
+void quatCobSoA( int caseNumber, double *&x, double *&y, double *&z, double *&w, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, QUAT_XYZW, p );
+	double *arrays[4] = { x, y, z, w };
+	detail::permuteSoA( p, arrays, count );
+	x = arrays[0];
+	y = arrays[1];
+	z = arrays[2];
+	w = arrays[3];
+}
+
+void quatCobSoA( int caseNumber, float *&x, float *&y, float *&z, float *&w, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, QUAT_XYZW, p );
+	float *arrays[4] = { x, y, z, w };
+	detail::permuteSoA( p, arrays, count );
+	x = arrays[0];
+	y = arrays[1];
+	z = arrays[2];
+	w = arrays[3];
+}
+
+void vectorCobAoSToSoA( int caseNumber, const double *src, double *x, double *y, double *z, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	double *const arrays[3] = { x, y, z };
+	detail::permuteToSoA( p, src, arrays, count );
+}
+
+void vectorCobSoAToAoS( int caseNumber, const double *x, const double *y, const double *z, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	const double *const arrays[3] = { x, y, z };
+	detail::permuteFromSoA( p, arrays, dst, count );
+}
+
+void vectorCobAoSToSoA( int caseNumber, const float *src, float *x, float *y, float *z, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	float *const arrays[3] = { x, y, z };
+	detail::permuteToSoA( p, src, arrays, count );
+}
+
+void vectorCobSoAToAoS( int caseNumber, const float *x, const float *y, const float *z, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	const float *const arrays[3] = { x, y, z };
+	detail::permuteFromSoA( p, arrays, dst, count );
+}
+
+// The component arrays are in the order of the packed layout so lane k goes with array k
+void quatCobAoSToSoA( int caseNumber, int layout, const double *src, double *x, double *y, double *z, double *w, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	double *const xyzw[4] = { x, y, z, w };
+	double *const wxyz[4] = { w, x, y, z };
+	detail::permuteToSoA( p, src, (layout == QUAT_WXYZ) ? wxyz : xyzw, count );
+}
+
+void quatCobSoAToAoS( int caseNumber, int layout, const double *x, const double *y, const double *z, const double *w, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	const double *const xyzw[4] = { x, y, z, w };
+	const double *const wxyz[4] = { w, x, y, z };
+	detail::permuteFromSoA( p, (layout == QUAT_WXYZ) ? wxyz : xyzw, dst, count );
+}
+
+void quatCobAoSToSoA( int caseNumber, int layout, const float *src, float *x, float *y, float *z, float *w, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	float *const xyzw[4] = { x, y, z, w };
+	float *const wxyz[4] = { w, x, y, z };
+	detail::permuteToSoA( p, src, (layout == QUAT_WXYZ) ? wxyz : xyzw, count );
+}
+
+void quatCobSoAToAoS( int caseNumber, int layout, const float *x, const float *y, const float *z, const float *w, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	const float *const xyzw[4] = { x, y, z, w };
+	const float *const wxyz[4] = { w, x, y, z };
+	detail::permuteFromSoA( p, (layout == QUAT_WXYZ) ? wxyz : xyzw, dst, count );
+}
+
+// The half float versions are the same code on uint16_t, where only the sign bit is flipped.
+void matrixCob3x3Half( int caseNumber,
+	uint16_t &a00, uint16_t &a01, uint16_t &a02,
+	uint16_t &a10, uint16_t &a11, uint16_t &a12,
+	uint16_t &a20, uint16_t &a21, uint16_t &a22 )
+{
+	inlined::matrixCob3x3( caseNumber, a00, a01, a02, a10, a11, a12, a20, a21, a22 );
+}
+
+void vectorCobHalf( int caseNumber, uint16_t &vx, uint16_t &vy, uint16_t &vz )
+{
+	inlined::vectorCob( caseNumber, vx, vy, vz );
+}
+
+void quatCobHalf( int caseNumber, uint16_t &qx, uint16_t &qy, uint16_t &qz, uint16_t &qw )
+{
+	inlined::quatCob( caseNumber, qx, qy, qz, qw );
+}
+
+void eulerCobHalf( int eulerCaseNumber, uint16_t &yaw, uint16_t &pitch, uint16_t &roll )
+{
+	inlined::eulerCob( eulerCaseNumber, yaw, pitch, roll );
+}
+
+void matrixCob3x3BatchHalf( int caseNumber, uint16_t *m, size_t count )
+{
+	matrixCob3x3BatchHalf( caseNumber, m, m, count );
+}
+
+void matrixCob3x3BatchHalf( int caseNumber, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void vectorCobBatchHalf( int caseNumber, uint16_t *v, size_t count )
+{
+	vectorCobBatchHalf( caseNumber, v, v, count );
+}
+
+void vectorCobBatchHalf( int caseNumber, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatchHalf( int caseNumber, int layout, uint16_t *q, size_t count )
+{
+	quatCobBatchHalf( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatchHalf( int caseNumber, int layout, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void eulerCobBatchHalf( int eulerCaseNumber, uint16_t *angles, size_t count )
+{
+	eulerCobBatchHalf( eulerCaseNumber, angles, angles, count );
+}
+
+void eulerCobBatchHalf( int eulerCaseNumber, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getEulerPermutation( eulerCaseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+// The integer versions saturate in the kernels.  See negateIf() in changeOfBasisInline.h.
+void matrixCob3x3Batch( int caseNumber, int16_t *m, size_t count )
+{
+	matrixCob3x3Batch( caseNumber, m, m, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, int32_t *m, size_t count )
+{
+	matrixCob3x3Batch( caseNumber, m, m, count );
+}
+
+void matrixCob3x3Batch( int caseNumber, const int32_t *src, int32_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void vectorCobBatch( int caseNumber, int16_t *v, size_t count )
+{
+	vectorCobBatch( caseNumber, v, v, count );
+}
+
+void vectorCobBatch( int caseNumber, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void vectorCobBatch( int caseNumber, int32_t *v, size_t count )
+{
+	vectorCobBatch( caseNumber, v, v, count );
+}
+
+void vectorCobBatch( int caseNumber, const int32_t *src, int32_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, int16_t *q, size_t count )
+{
+	quatCobBatch( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, int32_t *q, size_t count )
+{
+	quatCobBatch( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, int layout, const int32_t *src, int32_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, double *q, size_t count )
+{
+	quatCobBatch( caseNumber, in, out, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, in, out, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, float *q, size_t count )
+{
+	quatCobBatch( caseNumber, in, out, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, in, out, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, int16_t *q, size_t count )
+{
+	quatCobBatch( caseNumber, in, out, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, in, out, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, int32_t *q, size_t count )
+{
+	quatCobBatch( caseNumber, in, out, q, q, count );
+}
+
+void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const int32_t *src, int32_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, in, out, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, int16_t *angles, size_t count )
+{
+	eulerCobBatch( eulerCaseNumber, angles, angles, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getEulerPermutation( eulerCaseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, int32_t *angles, size_t count )
+{
+	eulerCobBatch( eulerCaseNumber, angles, angles, count );
+}
+
+void eulerCobBatch( int eulerCaseNumber, const int32_t *src, int32_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getEulerPermutation( eulerCaseNumber, p );
+	detail::permuteBatch( p, src, dst, count );
+}
+
+// Copies one field's permutation into the sample at offset.  Returns false when the field
+// runs past the end of the sample or lands on another field.
+static bool placeImuField( const detail::LanePermutation &field, int offset, bool *used, ImuCob &cob )
+{
+	if (offset < 0) return true;
+	if (offset + field.lanes > cob.stride) return false;
+
+	for (int k = 0; k < field.lanes; ++k)
 	{
-		case 0:   vx =  tx; vy =  ty; vz =  tz;  break;
-		case 1:   vx =  tx; vy =  ty; vz = -tz;  break;
-		case 2:   vx =  tx; vy = -ty; vz =  tz;  break;
-		case 3:   vx =  tx; vy = -ty; vz = -tz;  break;
-		case 4:   vx = -tx; vy =  ty; vz =  tz;  break;
-		case 5:   vx = -tx; vy =  ty; vz = -tz;  break;
-		case 6:   vx = -tx; vy = -ty; vz =  tz;  break;
-		case 7:   vx = -tx; vy = -ty; vz = -tz;  break;
-		case 8:   vx =  tx; vy =  tz; vz =  ty;  break;
-		case 9:   vx =  tx; vy = -tz; vz =  ty;  break;
-		case 10:   vx =  tx; vy =  tz; vz = -ty;  break;
-		case 11:   vx =  tx; vy = -tz; vz = -ty;  break;
-		case 12:   vx = -tx; vy =  tz; vz =  ty;  break;
-		case 13:   vx = -tx; vy = -tz; vz =  ty;  break;
-		case 14:   vx = -tx; vy =  tz; vz = -ty;  break;
-		case 15:   vx = -tx; vy = -tz; vz = -ty;  break;
-		case 16:   vx =  ty; vy =  tx; vz =  tz;  break;
-		case 17:   vx =  ty; vy =  tx; vz = -tz;  break;
-		case 18:   vx = -ty; vy =  tx; vz =  tz;  break;
-		case 19:   vx = -ty; vy =  tx; vz = -tz;  break;
-		case 20:   vx =  ty; vy = -tx; vz =  tz;  break;
-		case 21:   vx =  ty; vy = -tx; vz = -tz;  break;
-		case 22:   vx = -ty; vy = -tx; vz =  tz;  break;
-		case 23:   vx = -ty; vy = -tx; vz = -tz;  break;
-		case 24:   vx =  tz; vy =  tx; vz =  ty;  break;
-		case 25:   vx = -tz; vy =  tx; vz =  ty;  break;
-		case 26:   vx =  tz; vy =  tx; vz = -ty;  break;
-		case 27:   vx = -tz; vy =  tx; vz = -ty;  break;
-		case 28:   vx =  tz; vy = -tx; vz =  ty;  break;
-		case 29:   vx = -tz; vy = -tx; vz =  ty;  break;
-		case 30:   vx =  tz; vy = -tx; vz = -ty;  break;
-		case 31:   vx = -tz; vy = -tx; vz = -ty;  break;
-		case 32:   vx =  ty; vy =  tz; vz =  tx;  break;
-		case 33:   vx =  ty; vy = -tz; vz =  tx;  break;
-		case 34:   vx = -ty; vy =  tz; vz =  tx;  break;
-		case 35:   vx = -ty; vy = -tz; vz =  tx;  break;
-		case 36:   vx =  ty; vy =  tz; vz = -tx;  break;
-		case 37:   vx =  ty; vy = -tz; vz = -tx;  break;
-		case 38:   vx = -ty; vy =  tz; vz = -tx;  break;
-		case 39:   vx = -ty; vy = -tz; vz = -tx;  break;
-		case 40:   vx =  tz; vy =  ty; vz =  tx;  break;
-		case 41:   vx = -tz; vy =  ty; vz =  tx;  break;
-		case 42:   vx =  tz; vy = -ty; vz =  tx;  break;
-		case 43:   vx = -tz; vy = -ty; vz =  tx;  break;
-		case 44:   vx =  tz; vy =  ty; vz = -tx;  break;
-		case 45:   vx = -tz; vy =  ty; vz = -tx;  break;
-		case 46:   vx =  tz; vy = -ty; vz = -tx;  break;
-		case 47:   vx = -tz; vy = -ty; vz = -tx;  break;
+		if (used[offset + k]) return false;
+		used[offset + k] = true;
+		cob.index[offset + k] = static_cast<signed char>(offset + field.index[k]);
+		cob.negate[offset + k] = field.negate[k];
 	}
+	return true;
 }
 
-void getYawPitchRollRotationOrderFromAxisFrame( const triple &axisFrame, double &yaw, double &pitch, double &roll)
+static void setImuIdentity( int stride, ImuCob &cob )
 {
-	if (matchDirection( UP, axisFrame.a))
+	cob.stride = stride;
+	for (int k = 0; k < IMU_MAX_STRIDE; ++k)
 	{
-		if (UP != axisFrame.a)
-		{
-			pitch = -pitch;
-			roll = -roll;
-		}
-		if (matchDirection(RIGHT, axisFrame.b))
-		{
-			if (RIGHT != axisFrame.b)
-			{
-				yaw = -yaw;
-				roll = -roll;
-			}
-			if (FORWARD != axisFrame.c)
-			{
-				yaw = -yaw;
-				pitch = -pitch;
-			}
-		}
-		else	// matchDirection(RIGHT, axisFrame.c)
-		{
-			if (RIGHT != axisFrame.c)
-			{
-				yaw = -yaw;
-				roll = -roll;
-			}
-			if (FORWARD != axisFrame.b)
-			{
-				yaw = -yaw;
-				pitch = -pitch;
-			}
-		}
+		cob.index[k] = static_cast<signed char>(k);
+		cob.negate[k] = false;
 	}
-	else if (matchDirection( UP, axisFrame.b))
+}
+
+bool getImuCob( int caseNumber, const ImuLayout &layout, ImuCob &cob )
+{
+	if (layout.stride < 1 || layout.stride > IMU_MAX_STRIDE)
 	{
-		if (UP != axisFrame.b)
-		{
-			pitch = -pitch;
-			roll = -roll;
-		}
-		if (matchDirection(RIGHT, axisFrame.a))
-		{
-			if (RIGHT != axisFrame.a)
-			{
-				yaw = -yaw;
-				roll = -roll;
-			}
-			if (FORWARD != axisFrame.c)
-			{
-				yaw = -yaw;
-				pitch = -pitch;
-			}
-		}
-		else	// matchDirection(RIGHT, axisFrame.c)
-		{
-			if (RIGHT != axisFrame.c)
-			{
-				yaw = -yaw;
-				roll = -roll;
-			}
-			if (FORWARD != axisFrame.a)
-			{
-				yaw = -yaw;
-				pitch = -pitch;
-			}
-		}
+		setImuIdentity( (layout.stride < 1) ? 1 : IMU_MAX_STRIDE, cob );
+		return false;
 	}
-	else // UP matches with axisFrame.c
+
+	setImuIdentity( layout.stride, cob );
+
+	detail::LanePermutation vector, pseudoVector, quat;
+	detail::getVectorPermutation( caseNumber, vector );
+	detail::getPseudoVectorPermutation( caseNumber, pseudoVector );
+	detail::getQuatPermutation( caseNumber, layout.quatLayout, quat );
+
+	bool used[IMU_MAX_STRIDE] = {};
+	if (placeImuField( vector, layout.accel, used, cob ) &&
+		placeImuField( pseudoVector, layout.gyro, used, cob ) &&
+		placeImuField( pseudoVector, layout.mag, used, cob ) &&
+		placeImuField( quat, layout.quat, used, cob ))
 	{
-		if (UP != axisFrame.c)
-		{
-			pitch = -pitch;
-			roll = -roll;
-		}
-		if (matchDirection(RIGHT, axisFrame.a))
-		{
-			if (RIGHT != axisFrame.a)
-			{
-				yaw = -yaw;
-				roll = -roll;
-			}
-			if (FORWARD != axisFrame.b)
-			{
-				yaw = -yaw;
-				pitch = -pitch;
-			}
-		}
-		else	// matchDirection(RIGHT, axisFrame.b)
-		{
-			if (RIGHT != axisFrame.b)
-			{
-				yaw = -yaw;
-				roll = -roll;
-			}
-			if (FORWARD != axisFrame.a)
-			{
-				yaw = -yaw;
-				pitch = -pitch;
-			}
-		}
+		return true;
 	}
+
+	setImuIdentity( layout.stride, cob );
+	return false;
 }
 
-void eulerCob( const triple &fromFrame, const triple &toFrame, double &yaw, double &pitch, double &roll );
+bool getImuCob( const triple &from, const triple &to, const ImuLayout &layout, ImuCob &cob )
+{
+	return getImuCob( inlined::getCaseNumber( from, to ), layout, cob );
+}
 
-int getEulerCaseNumber( const triple &from,	const triple &to)
+void imuCobBatch( const ImuCob &cob, double *samples, size_t count )
+{
+	imuCobBatch( cob, samples, samples, count );
+}
+
+void imuCobBatch( const ImuCob &cob, const double *src, double *dst, size_t count )
 {
-	int eulerCaseNumber = 0;
+	detail::LanePermutation p;
+	detail::getImuPermutation( cob, p );
+	detail::permuteBatch( p, src, dst, count );
+}
 
-	double signYaw(1.0), signPitch(1.0), signRoll(1.0);
+void imuCobBatch( const ImuCob &cob, float *samples, size_t count )
+{
+	imuCobBatch( cob, samples, samples, count );
+}
 
-	eulerCob( from, to, signYaw, signPitch, signRoll);
+void imuCobBatch( const ImuCob &cob, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getImuPermutation( cob, p );
+	detail::permuteBatch( p, src, dst, count );
+}
 
-	if (signYaw < 0.0) eulerCaseNumber |= 0x04;
-	if (signPitch < 0.0) eulerCaseNumber |= 0x02;
-	if (signRoll < 0.0) eulerCaseNumber |= 0x01;
+void imuCobBatch( const ImuCob &cob, int16_t *samples, size_t count )
+{
+	imuCobBatch( cob, samples, samples, count );
+}
 
-	return eulerCaseNumber;
+void imuCobBatch( const ImuCob &cob, const int16_t *src, int16_t *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getImuPermutation( cob, p );
+	detail::permuteBatch( p, src, dst, count );
 }
 
-void eulerCob( int eulerCaseNumber, double &yaw, double &pitch, double &roll)
+void imuCobBatch( const ImuCob &cob, int32_t *samples, size_t count )
 {
-	if (eulerCaseNumber & 0x04) yaw = -yaw;
-	if (eulerCaseNumber & 0x02) pitch = -pitch;
-	if (eulerCaseNumber & 0x01) roll = -roll;
+	imuCobBatch( cob, samples, samples, count );
 }
 
-void eulerCob( const triple &fromFrame, const triple &toFrame, double &yaw, double &pitch, double &roll )
+void imuCobBatch( const ImuCob &cob, const int32_t *src, int32_t *dst, size_t count )
 {
-	// Create normalized versions of the frames that can only contain Forward, Right, and Up
-	triple newFromFrame( fromFrame.a & 3, fromFrame.b & 3, fromFrame.c & 3);
-	triple newToFrame( toFrame.a & 3, toFrame.b & 3, toFrame.c & 3);
-
-	// Convert to normalized frames by flipping axes if Back, Left, or Down are used.
-	// If an axis is flipped, the sign of that rotation is kept but the other two reverse.
-	getYawPitchRollRotationOrderFromAxisFrame( fromFrame, yaw, pitch, roll  );
-	getYawPitchRollRotationOrderFromAxisFrame( toFrame, yaw, pitch, roll );
-
-	// Now we are only left with six cases between the two normalized frames
-	// The conversion between the normalized frames has no effect on yaw,pitch,roll with
-	// the exception that if the conversion has a reflection in it then all the angles
-	// change sign.
-	int p = getCaseNumber( newFromFrame, newToFrame ) >> 3;
-	if (p == 1 || p == 2 || p == 5)
-	{
-		// change between frames has a reflection
-		yaw = -yaw;
-		pitch = -pitch;
-		roll = -roll;
-	}
+	detail::LanePermutation p;
+	detail::getImuPermutation( cob, p );
+	detail::permuteBatch( p, src, dst, count );
 }
 
 } // namespace cob
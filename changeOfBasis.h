@@ -19,6 +19,9 @@
 #ifndef CHANGEOFBASIS_H
 #define	CHANGEOFBASIS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 // A Change of Basis is converting a quantity to another reference frame.
 // Changing a vector to another reference frame is straightforward but
 // changing a rotation to another frame is not as easy and is poorly
@@ -38,7 +41,7 @@ namespace cob
 
 	struct triple
 	{
-		triple(int aa, int bb, int cc)
+		constexpr triple(int aa, int bb, int cc)
 			: a(aa), b(bb), c(cc)
 		{
 		}
@@ -49,13 +52,13 @@ namespace cob
 	// the point of view of a character.  For instance if a character is looking foward along
 	// the positive X axis, Y is to his right and Z is up then the reference frame would
 	// be (Forward, Right, Up).
-	const triple Unreal3Frame( FORWARD, RIGHT, UP );
-	const triple OpenGLFrame( LEFT, UP, FORWARD );
-	const triple OculusFrame( RIGHT, UP, BACK );
-	const triple BvhFrame( LEFT, UP, FORWARD );
-	const triple BvhBlenderFrame( LEFT, FORWARD, UP );
-	const triple KinectFrame( RIGHT, UP, BACK );
-	const triple PrioVRFrame( RIGHT, UP, FORWARD );
+	constexpr triple Unreal3Frame( FORWARD, RIGHT, UP );
+	constexpr triple OpenGLFrame( LEFT, UP, FORWARD );
+	constexpr triple OculusFrame( RIGHT, UP, BACK );
+	constexpr triple BvhFrame( LEFT, UP, FORWARD );
+	constexpr triple BvhBlenderFrame( LEFT, FORWARD, UP );
+	constexpr triple KinectFrame( RIGHT, UP, BACK );
+	constexpr triple PrioVRFrame( RIGHT, UP, FORWARD );
 
 	// To use the Change of Basis on a matrix, vector or a quaternion, call this first
 	// with the two frames ("from" and "to").  
@@ -63,9 +66,41 @@ namespace cob
 		const triple &from,	// make a triple from a permutation of (FORWARD or BACK, LEFT or RIGHT, UP or DOWN )
 		const triple &to );	// make a triple from a permutation of (FORWARD or BACK, LEFT or RIGHT, UP or DOWN )
 
+	// Compact Frame Ids
+	// There are only 48 valid frames so each one has an id from 0 to 47 that fits in a byte.
+	// Ids are cheaper to store and send than a triple, and the case numbers between two ids
+	// are looked up in a table instead of being worked out.
+	typedef unsigned char FrameId;
+	const int FRAME_COUNT = 48;
+
+	// FRAME_COUNT when frame isn't one of the 48 frames (ex. two directions on one axis)
+	FrameId getFrameId( const triple &frame );
+
+	// ( -1, -1, -1 ), which isn't a frame and has the id FRAME_COUNT, when id is FRAME_COUNT or more
+	triple getFrameFromId( FrameId id );
+
+	// Same as getCaseNumber() and getEulerCaseNumber() on the frames.  The ids must be less than FRAME_COUNT.
+	int getCaseNumber( FrameId from, FrameId to );
+	int getEulerCaseNumber( FrameId from, FrameId to );
+
+	// Chaining Conversions
+	// The case numbers form a group so a chain of conversions can be done in one step.
+	// composeCase( getCaseNumber( A, B ), getCaseNumber( B, C ) ) == getCaseNumber( A, C )
+	// The case numbers passed to these must be 0 to 47.
+	int composeCase( int caseAtoB, int caseBtoC );
+
+	// The case number that undoes caseNumber, so converting B back to A.
+	int inverseCase( int caseNumber );
+
+	// True when MAtoB has a determinant of -1, so one frame is right handed and the other left handed.
+	bool isReflection( int caseNumber );
+
+	// True when the conversion does nothing.  A round trip composes to the identity.
+	bool isIdentity( int caseNumber );
+
 	// Matrix Change of Basis
 	// The caseNumber is described above and represents the matrix MAtoB.
-	// The matrix MA passed in must be a column matrix of doubles 
+	// The matrix MA passed in must be a column matrix of doubles or floats
 	// (ex. The first basis vector is the column 
 	// [ MA00 ]
 	// [ MA10 ]
@@ -81,10 +116,93 @@ namespace cob
 		double &MA00, double &MA01, double &MA02,
 		double &MA10, double &MA11, double &MA12,
 		double &MA20, double &MA21, double &MA22);
+	void matrixCob3x3(int caseNumber, 
+		float &MA00, float &MA01, float &MA02,
+		float &MA10, float &MA11, float &MA12,
+		float &MA20, float &MA21, float &MA22);
 
 	// Vector Change of Basis
 	// Performs [ VB ] = [ MAtoB ] . [ VA ]
 	void vectorCob( int caseNumber, double &vAx, double &vAy, double &vAz );
+	void vectorCob( int caseNumber, float &vAx, float &vAy, float &vAz );
+
+	// Pseudovector Change of Basis
+	// Angular velocities (gyroscope rates), angular momenta, torques and magnetic fields are
+	// axial vectors.  They change like a vector except that all three components change sign
+	// once more when one frame is right handed and the other is left handed (isReflection()).
+	// Performs [ VB ] = det([ MAtoB ]) [ MAtoB ] . [ VA ]
+	void pseudoVectorCob( int caseNumber, double &vAx, double &vAy, double &vAz );
+	void pseudoVectorCob( int caseNumber, float &vAx, float &vAy, float &vAz );
+
+	// Batch Pseudovector Change of Basis
+	// Same as pseudoVectorCob() but for count vectors packed as x, y, z, x, y, z, ...
+	// The integer versions saturate like the other integer batch functions.
+	void pseudoVectorCobBatch( int caseNumber, double *v, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, const double *src, double *dst, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, float *v, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, const float *src, float *dst, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, int16_t *v, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, const int16_t *src, int16_t *dst, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, int32_t *v, size_t count );
+	void pseudoVectorCobBatch( int caseNumber, const int32_t *src, int32_t *dst, size_t count );
+
+	// Batch Matrix Change of Basis
+	// Same as matrixCob3x3() but for count matrices packed one after another.  Each matrix is
+	// 9 values in the same order as the arguments of matrixCob3x3() (m00, m01, m02, m10, ...).
+	// The case number is decoded once per call and the work is done with SIMD when the CPU has it.
+	// src and dst may be the same array.
+	void matrixCob3x3Batch( int caseNumber, double *m, size_t count );
+	void matrixCob3x3Batch( int caseNumber, const double *src, double *dst, size_t count );
+	void matrixCob3x3Batch( int caseNumber, float *m, size_t count );
+	void matrixCob3x3Batch( int caseNumber, const float *src, float *dst, size_t count );
+
+	// Memory layouts for matrices and transforms.  The batch functions above are MATRIX_ROW_MAJOR.
+	const int MATRIX_ROW_MAJOR = 0;		// one row after another    (ex. DirectXMath, Unreal FMatrix)
+	const int MATRIX_COLUMN_MAJOR = 1;	// one column after another (ex. glm, Eigen)
+
+	// Same as above but reads matrices stored in inLayout and writes them in outLayout.  When
+	// the layouts differ the matrices come out transposed in memory, which is the same as
+	// writing transpose([ MB ]) in inLayout.  The transpose is folded into the same shuffle so
+	// it costs nothing extra.  src and dst may be the same array.
+	void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, double *m, size_t count );
+	void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, const double *src, double *dst, size_t count );
+	void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, float *m, size_t count );
+	void matrixCob3x3Batch( int caseNumber, int inLayout, int outLayout, const float *src, float *dst, size_t count );
+
+	// Rigid Transform Change of Basis
+	// A 4x4 homogeneous transform [ R t ; 0 1 ] is changed by [ P ] . [ MA ] . transpose([ P ])
+	// where P is MAtoB with a 1 added in the corner.  The rotation block changes the same as
+	// matrixCob3x3() and the translation the same as vectorCob(), in one pass over the 16 values.
+	// Because P is a signed permutation the same moves work whether the 4x4 is stored row-major
+	// or column-major, and whether the translation is in the last column or the last row.
+	void matrixCob4x4( int caseNumber, double *m );
+	void matrixCob4x4( int caseNumber, float *m );
+
+	// Same as matrixCob4x4() on the 12 values of a transform without the constant bottom row,
+	// stored MATRIX_ROW_MAJOR (ex. DirectX XMFLOAT3X4) or MATRIX_COLUMN_MAJOR.
+	// A 3x4 stored MATRIX_COLUMN_MAJOR is the same in memory as a 4x3 (translation in the last
+	// row) stored row-major.
+	void matrixCob3x4( int caseNumber, int layout, double *m );
+	void matrixCob3x4( int caseNumber, int layout, float *m );
+
+	// Batch Rigid Transform Change of Basis
+	// Same as above for count transforms packed one after another, such as instance transforms
+	// or a skinning matrix palette.  src and dst may be the same array.
+	void matrixCob4x4Batch( int caseNumber, double *m, size_t count );
+	void matrixCob4x4Batch( int caseNumber, const double *src, double *dst, size_t count );
+	void matrixCob4x4Batch( int caseNumber, float *m, size_t count );
+	void matrixCob4x4Batch( int caseNumber, const float *src, float *dst, size_t count );
+	void matrixCob3x4Batch( int caseNumber, int layout, double *m, size_t count );
+	void matrixCob3x4Batch( int caseNumber, int layout, const double *src, double *dst, size_t count );
+	void matrixCob3x4Batch( int caseNumber, int layout, float *m, size_t count );
+	void matrixCob3x4Batch( int caseNumber, int layout, const float *src, float *dst, size_t count );
+
+	// Batch Vector Change of Basis
+	// Same as vectorCob() but for count vectors packed as x, y, z, x, y, z, ...
+	void vectorCobBatch( int caseNumber, double *v, size_t count );
+	void vectorCobBatch( int caseNumber, const double *src, double *dst, size_t count );
+	void vectorCobBatch( int caseNumber, float *v, size_t count );
+	void vectorCobBatch( int caseNumber, const float *src, float *dst, size_t count );
 
 	// Quaternion Change of Basis
 	// The caseNumber is described above and represents the matrix MAtoB.
@@ -95,10 +213,66 @@ namespace cob
 	// The calculation is done such that qw does not change.  qw doesn't actually
 	// need to be a parameter.
 	void quatCob( int caseNumber, double &qx, double &qy, double &qz, double &qw );
+	void quatCob( int caseNumber, float &qx, float &qy, float &qz, float &qw );
+
+	// Memory layouts for arrays of quaternions passed to the batch functions.
+	const int QUAT_XYZW = 0;	// qx, qy, qz, qw  (ex. Unreal, glm)
+	const int QUAT_WXYZ = 1;	// qw, qx, qy, qz  (ex. Eigen)
+
+	// Batch Quaternion Change of Basis
+	// Same as quatCob() but for count quaternions packed one after another in
+	// the given layout (4 values each).  The case number is decoded once per call
+	// so the loop over the quaternions is only loads, sign changes and stores.
+	void quatCobBatch( int caseNumber, int layout, double *q, size_t count );
+	void quatCobBatch( int caseNumber, int layout, float *q, size_t count );
+
+	// Same as above but reads from src and writes to dst.  src and dst may be the same array.
+	void quatCobBatch( int caseNumber, int layout, const double *src, double *dst, size_t count );
+	void quatCobBatch( int caseNumber, int layout, const float *src, float *dst, size_t count );
+
+	// Quaternion conventions.  A JPL quaternion is the conjugate of the Hamilton quaternion
+	// for the same rotation, so changing between them negates qx, qy and qz.
+	const int QUAT_HAMILTON = 0;	// (ex. Eigen, Unreal, glm, ROS)
+	const int QUAT_JPL = 1;			// (ex. many spacecraft and visual-inertial odometry codes)
+
+	// How an array of quaternions is stored
+	struct QuatFormat
+	{
+		int layout;			// QUAT_XYZW or QUAT_WXYZ
+		int convention;		// QUAT_HAMILTON or QUAT_JPL
+	};
+
+	// Same as quatCobBatch() but reads quaternions in the in format and writes them in the out
+	// format.  The reorder, the conjugation and the change of basis are one shuffle and one
+	// sign mask per quaternion, so the array is only read and written once.  An invalid case
+	// number still changes the format.  src and dst may be the same array.
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, double *q, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const double *src, double *dst, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, float *q, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const float *src, float *dst, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, int16_t *q, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const int16_t *src, int16_t *dst, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, int32_t *q, size_t count );
+	void quatCobBatch( int caseNumber, const QuatFormat &in, const QuatFormat &out, const int32_t *src, int32_t *dst, size_t count );
+
+	// The batch functions check the CPU when the library is loaded and use the fastest
+	// kernels it supports, so one binary runs well on any x86 machine.
+	const int SIMD_NONE = 0;		// portable C++ (still SSE2 on x86-64)
+	const int SIMD_AVX2 = 1;
+	const int SIMD_AVX512 = 2;
+
+	// The SIMD level the batch functions are currently using.
+	int getSimdLevel();
+
+	// Use a lower SIMD level than the CPU supports, for testing or benchmarking.  Levels the
+	// CPU doesn't support are clamped to the best one it does.  Returns the level now in use.
+	// Don't call this while other threads are running batch functions.
+	int setSimdLevel( int level );
 
 	// Euler Angle (yaw, pitch, roll) Change of Basis
 	// The Euler Case Number is a piece of data that makes it faster to perform a Change of Basis
-	// on multiple sets of euler angles using the same "from" and "to".
+	// on multiple sets of euler angles using the same "from" and "to".  It is 0, which changes
+	// nothing, when either triple isn't a valid frame.
 	int getEulerCaseNumber( 
 		const triple &from,				// make a triple from a permutation of (FORWARD or BACK, LEFT or RIGHT, UP or DOWN )
 		const triple &to);				// make a triple from a permutation of (FORWARD or BACK, LEFT or RIGHT, UP or DOWN )
@@ -113,6 +287,15 @@ namespace cob
 	// to euler angles.  The net result is just potential change of signs.
 	// Since it only changes their signs, this function works on radians and degrees.
 	void eulerCob( int eulerCaseNumber, double &yaw, double &pitch, double &roll );
+	void eulerCob( int eulerCaseNumber, float &yaw, float &pitch, float &roll );
+
+	// Batch Euler Angle Change of Basis
+	// Same as eulerCob() but for count sets of angles packed as yaw, pitch, roll, yaw, pitch, roll, ...
+	// The signs are changed by flipping sign bits with SIMD when the CPU has it.
+	void eulerCobBatch( int eulerCaseNumber, double *angles, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, const double *src, double *dst, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, float *angles, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, const float *src, float *dst, size_t count );
 
 	// Euler Angle (yaw, pitch, roll) Change of Basis
 	// Same as above but is slower across multiple calls since it has to the do work
@@ -120,6 +303,164 @@ namespace cob
 	// Since it only changes their signs, this function works on radians and degrees.
 	void eulerCob( const triple &from, const triple &to, double &yaw, double &pitch, double &roll );
 
+	// Mixed Batch Change of Basis
+	// Same as the batch functions above but element n uses caseNumbers[n], for streams that mix
+	// data from several frames (ex. a sensor on every body segment, each mounted its own way).
+	// Elements with an invalid case number are copied unchanged.  Runs of one case number cost
+	// the same as the ordinary batch functions, and mixed case numbers don't cost a branch per
+	// element.  A case number per element from frame ids is a getCaseNumber( FrameId, FrameId ).
+	void vectorCobBatchMixed( const int *caseNumbers, double *v, size_t count );
+	void vectorCobBatchMixed( const int *caseNumbers, const double *src, double *dst, size_t count );
+	void vectorCobBatchMixed( const int *caseNumbers, float *v, size_t count );
+	void vectorCobBatchMixed( const int *caseNumbers, const float *src, float *dst, size_t count );
+	void quatCobBatchMixed( const int *caseNumbers, int layout, double *q, size_t count );
+	void quatCobBatchMixed( const int *caseNumbers, int layout, const double *src, double *dst, size_t count );
+	void quatCobBatchMixed( const int *caseNumbers, int layout, float *q, size_t count );
+	void quatCobBatchMixed( const int *caseNumbers, int layout, const float *src, float *dst, size_t count );
+	void matrixCob3x3BatchMixed( const int *caseNumbers, double *m, size_t count );
+	void matrixCob3x3BatchMixed( const int *caseNumbers, const double *src, double *dst, size_t count );
+	void matrixCob3x3BatchMixed( const int *caseNumbers, float *m, size_t count );
+	void matrixCob3x3BatchMixed( const int *caseNumbers, const float *src, float *dst, size_t count );
+
+	// Strided Batch Change of Basis
+	// Same as the batch functions above but for a field inside an array of your own structs
+	// (ex. the velocity of every particle), so nothing has to be repacked first.  Pass the field
+	// in the first struct, which is the base pointer plus the field's offset, and the stride in
+	// bytes from one struct to the next, which is usually sizeof() the struct.  Nothing outside
+	// the field is read or written and the field doesn't have to be aligned.  src and dst are
+	// either the same array with the same stride or do not overlap.
+	//
+	// example:
+	//   cob::vectorCobBatchStrided( caseNumber, &particles[0].velocity.x, sizeof(Particle), count );
+	void vectorCobBatchStrided( int caseNumber, double *v, size_t stride, size_t count );
+	void vectorCobBatchStrided( int caseNumber, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count );
+	void vectorCobBatchStrided( int caseNumber, float *v, size_t stride, size_t count );
+	void vectorCobBatchStrided( int caseNumber, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count );
+	void quatCobBatchStrided( int caseNumber, int layout, double *q, size_t stride, size_t count );
+	void quatCobBatchStrided( int caseNumber, int layout, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count );
+	void quatCobBatchStrided( int caseNumber, int layout, float *q, size_t stride, size_t count );
+	void quatCobBatchStrided( int caseNumber, int layout, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count );
+	void matrixCob3x3BatchStrided( int caseNumber, double *m, size_t stride, size_t count );
+	void matrixCob3x3BatchStrided( int caseNumber, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count );
+	void matrixCob3x3BatchStrided( int caseNumber, float *m, size_t stride, size_t count );
+	void matrixCob3x3BatchStrided( int caseNumber, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count );
+
+	// Structure of Arrays Change of Basis
+	// For data kept as separate component arrays (ex. x[], y[] and z[] in a simulation).  A change
+	// of basis only reorders the components and changes some of their signs, so these swap the
+	// array pointers and negate only the arrays that change sign.  Arrays that are only moved
+	// aren't read or written at all.  Afterwards x, y, z (and w) point at the converted
+	// components, which are the same count entry arrays in a different order.
+	void vectorCobSoA( int caseNumber, double *&x, double *&y, double *&z, size_t count );
+	void vectorCobSoA( int caseNumber, float *&x, float *&y, float *&z, size_t count );
+	void pseudoVectorCobSoA( int caseNumber, double *&x, double *&y, double *&z, size_t count );
+	void pseudoVectorCobSoA( int caseNumber, float *&x, float *&y, float *&z, size_t count );
+	void quatCobSoA( int caseNumber, double *&x, double *&y, double *&z, double *&w, size_t count );
+	void quatCobSoA( int caseNumber, float *&x, float *&y, float *&z, float *&w, size_t count );
+
+	// Converts packed elements (an array of structures, ex. for a renderer or a file) to
+	// component arrays, or back, and changes the basis in the same pass.  layout is the order of
+	// the packed quaternions.  The packed array and the component arrays must not overlap.
+	void vectorCobAoSToSoA( int caseNumber, const double *src, double *x, double *y, double *z, size_t count );
+	void vectorCobAoSToSoA( int caseNumber, const float *src, float *x, float *y, float *z, size_t count );
+	void vectorCobSoAToAoS( int caseNumber, const double *x, const double *y, const double *z, double *dst, size_t count );
+	void vectorCobSoAToAoS( int caseNumber, const float *x, const float *y, const float *z, float *dst, size_t count );
+	void quatCobAoSToSoA( int caseNumber, int layout, const double *src, double *x, double *y, double *z, double *w, size_t count );
+	void quatCobAoSToSoA( int caseNumber, int layout, const float *src, float *x, float *y, float *z, float *w, size_t count );
+	void quatCobSoAToAoS( int caseNumber, int layout, const double *x, const double *y, const double *z, const double *w, double *dst, size_t count );
+	void quatCobSoAToAoS( int caseNumber, int layout, const float *x, const float *y, const float *z, const float *w, float *dst, size_t count );
+
+
+	// Half Precision Change of Basis
+	// Same as the functions above but on IEEE half floats stored as uint16_t (ex. compressed
+	// animation tracks or GPU buffers).  Only the sign bits change so the results are exact.
+	void matrixCob3x3Half( int caseNumber,
+		uint16_t &MA00, uint16_t &MA01, uint16_t &MA02,
+		uint16_t &MA10, uint16_t &MA11, uint16_t &MA12,
+		uint16_t &MA20, uint16_t &MA21, uint16_t &MA22 );
+	void vectorCobHalf( int caseNumber, uint16_t &vAx, uint16_t &vAy, uint16_t &vAz );
+	void quatCobHalf( int caseNumber, uint16_t &qx, uint16_t &qy, uint16_t &qz, uint16_t &qw );
+	void eulerCobHalf( int eulerCaseNumber, uint16_t &yaw, uint16_t &pitch, uint16_t &roll );
+
+	void matrixCob3x3BatchHalf( int caseNumber, uint16_t *m, size_t count );
+	void matrixCob3x3BatchHalf( int caseNumber, const uint16_t *src, uint16_t *dst, size_t count );
+	void vectorCobBatchHalf( int caseNumber, uint16_t *v, size_t count );
+	void vectorCobBatchHalf( int caseNumber, const uint16_t *src, uint16_t *dst, size_t count );
+	void quatCobBatchHalf( int caseNumber, int layout, uint16_t *q, size_t count );
+	void quatCobBatchHalf( int caseNumber, int layout, const uint16_t *src, uint16_t *dst, size_t count );
+	void eulerCobBatchHalf( int eulerCaseNumber, uint16_t *angles, size_t count );
+	void eulerCobBatchHalf( int eulerCaseNumber, const uint16_t *src, uint16_t *dst, size_t count );
+
+	// Integer Batch Change of Basis
+	// Same as the batch functions above but on raw sensor counts, so the frame can be changed
+	// before scaling to physical units and nothing is rounded.  Changing the sign of the most
+	// negative value saturates (INT16_MIN becomes INT16_MAX) so every result fits in the type.
+	// For single elements use the cob::inlined functions in changeOfBasisInline.h.
+	void matrixCob3x3Batch( int caseNumber, int16_t *m, size_t count );
+	void matrixCob3x3Batch( int caseNumber, const int16_t *src, int16_t *dst, size_t count );
+	void matrixCob3x3Batch( int caseNumber, int32_t *m, size_t count );
+	void matrixCob3x3Batch( int caseNumber, const int32_t *src, int32_t *dst, size_t count );
+	void vectorCobBatch( int caseNumber, int16_t *v, size_t count );
+	void vectorCobBatch( int caseNumber, const int16_t *src, int16_t *dst, size_t count );
+	void vectorCobBatch( int caseNumber, int32_t *v, size_t count );
+	void vectorCobBatch( int caseNumber, const int32_t *src, int32_t *dst, size_t count );
+	void quatCobBatch( int caseNumber, int layout, int16_t *q, size_t count );
+	void quatCobBatch( int caseNumber, int layout, const int16_t *src, int16_t *dst, size_t count );
+	void quatCobBatch( int caseNumber, int layout, int32_t *q, size_t count );
+	void quatCobBatch( int caseNumber, int layout, const int32_t *src, int32_t *dst, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, int16_t *angles, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, const int16_t *src, int16_t *dst, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, int32_t *angles, size_t count );
+	void eulerCobBatch( int eulerCaseNumber, const int32_t *src, int32_t *dst, size_t count );
+
+	// IMU Sample Change of Basis
+	// An IMU sample holds an accelerometer vector, gyroscope and magnetometer pseudovectors and
+	// an orientation quaternion, all of the same type.  Converting arrays of them with the batch
+	// functions above reads and writes the buffer once per field.  ImuCob is worked out once for
+	// a case number and a sample layout, then imuCobBatch() converts every field of every sample
+	// in a single pass.
+
+	// The most scalars in one sample
+	const int IMU_MAX_STRIDE = 16;
+
+	// Where each field starts in a sample, counted in scalars, or -1 when the sample doesn't
+	// have it.  Scalars that aren't part of a field (ex. a temperature) are copied unchanged.
+	struct ImuLayout
+	{
+		int stride;			// scalars from one sample to the next
+		int accel;
+		int gyro;
+		int mag;
+		int quat;
+		int quatLayout;		// QUAT_XYZW or QUAT_WXYZ
+	};
+
+	// ax, ay, az, gx, gy, gz, mx, my, mz, qx, qy, qz, qw
+	const ImuLayout ImuPackedLayout = { 13, 0, 3, 6, 9, QUAT_XYZW };
+
+	// The precomputed source lane and sign of every scalar in a sample.
+	struct ImuCob
+	{
+		int stride;
+		signed char index[IMU_MAX_STRIDE];
+		bool negate[IMU_MAX_STRIDE];
+	};
+
+	// Returns false and sets cob to copy samples unchanged when the fields overlap or don't
+	// fit in the stride.  An invalid case number also leaves the samples unchanged.
+	bool getImuCob( int caseNumber, const ImuLayout &layout, ImuCob &cob );
+	bool getImuCob( const triple &from, const triple &to, const ImuLayout &layout, ImuCob &cob );
+
+	// Converts count samples.  src and dst may be the same array.
+	// The integer versions saturate like the other integer batch functions.
+	void imuCobBatch( const ImuCob &cob, double *samples, size_t count );
+	void imuCobBatch( const ImuCob &cob, const double *src, double *dst, size_t count );
+	void imuCobBatch( const ImuCob &cob, float *samples, size_t count );
+	void imuCobBatch( const ImuCob &cob, const float *src, float *dst, size_t count );
+	void imuCobBatch( const ImuCob &cob, int16_t *samples, size_t count );
+	void imuCobBatch( const ImuCob &cob, const int16_t *src, int16_t *dst, size_t count );
+	void imuCobBatch( const ImuCob &cob, int32_t *samples, size_t count );
+	void imuCobBatch( const ImuCob &cob, const int32_t *src, int32_t *dst, size_t count );
 
 	// This is for testing or for showing customers what is going on under the hood.
 	// You provide the members of a 3x3 column vector and a caseNumber and this sets the matrix
@@ -0,0 +1,729 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef CHANGEOFBASIS_INLINE_H
+#define	CHANGEOFBASIS_INLINE_H
+
+#include "changeOfBasis.h"
+
+#include <string.h>
+
+// Header only versions of the Change of Basis.
+// Everything in cob::inlined can be inlined into your own loops so the values stay in
+// registers instead of going through memory for every call.  The functions are templates
+// so they work on float as well as double, and there are overloads that take and return
+// small value types.  uint16_t is taken to be the bits of an IEEE half float, and
+// int16_t and int32_t saturate like the integer batch functions.  The functions in
+// changeOfBasis.cpp are built on these.
+//
+// example:
+//   cob::Quaternion<float> q = { x, y, z, w };
+//   q = cob::inlined::quatCob( caseNumber, q );
+
+namespace cob
+{
+	template <typename T>
+	struct Vector3
+	{
+		T x, y, z;
+	};
+
+	template <typename T>
+	struct Quaternion
+	{
+		T x, y, z, w;
+	};
+
+	// The elements are in the same order as the arguments of matrixCob3x3()
+	template <typename T>
+	struct Matrix3x3
+	{
+		T m[3][3];
+	};
+
+	template <typename T>
+	struct EulerAngles
+	{
+		T yaw, pitch, roll;
+	};
+
+	namespace detail
+	{
+		// The case tables.  Every case is the signed permutation MAtoB = P . S described
+		// in changeOfBasis.cpp.  For each case this lists which component of a vector in
+		// frame A lands in each component of the vector in frame B, and whether its sign
+		// changes on the way.  reflection is set when MAtoB has a determinant of -1 (it
+		// swaps handedness).
+		//
+		// [ VB ] = [ MAtoB ] . [ VA ]   is   VB[k] = sign(negate[k]) * VA[ index[k] ]
+		//
+		// The tables were generated from the same derivation as the original switch
+		// statements and are checked against the full math by the tests.
+		struct CaseDescriptor
+		{
+			unsigned char index[3];		// component of the "from" vector that lands in each component
+			unsigned char negate[3];	// 1 when that component changes sign
+			unsigned char reflection;	// 1 when MAtoB has a determinant of -1
+		};
+
+		constexpr CaseDescriptor caseTable[48] =
+		{
+		{ { 0, 1, 2 }, { 0, 0, 0 }, 0 },	// 0
+		{ { 0, 1, 2 }, { 0, 0, 1 }, 1 },	// 1
+		{ { 0, 1, 2 }, { 0, 1, 0 }, 1 },	// 2
+		{ { 0, 1, 2 }, { 0, 1, 1 }, 0 },	// 3
+		{ { 0, 1, 2 }, { 1, 0, 0 }, 1 },	// 4
+		{ { 0, 1, 2 }, { 1, 0, 1 }, 0 },	// 5
+		{ { 0, 1, 2 }, { 1, 1, 0 }, 0 },	// 6
+		{ { 0, 1, 2 }, { 1, 1, 1 }, 1 },	// 7
+		{ { 0, 2, 1 }, { 0, 0, 0 }, 1 },	// 8
+		{ { 0, 2, 1 }, { 0, 1, 0 }, 0 },	// 9
+		{ { 0, 2, 1 }, { 0, 0, 1 }, 0 },	// 10
+		{ { 0, 2, 1 }, { 0, 1, 1 }, 1 },	// 11
+		{ { 0, 2, 1 }, { 1, 0, 0 }, 0 },	// 12
+		{ { 0, 2, 1 }, { 1, 1, 0 }, 1 },	// 13
+		{ { 0, 2, 1 }, { 1, 0, 1 }, 1 },	// 14
+		{ { 0, 2, 1 }, { 1, 1, 1 }, 0 },	// 15
+		{ { 1, 0, 2 }, { 0, 0, 0 }, 1 },	// 16
+		{ { 1, 0, 2 }, { 0, 0, 1 }, 0 },	// 17
+		{ { 1, 0, 2 }, { 1, 0, 0 }, 0 },	// 18
+		{ { 1, 0, 2 }, { 1, 0, 1 }, 1 },	// 19
+		{ { 1, 0, 2 }, { 0, 1, 0 }, 0 },	// 20
+		{ { 1, 0, 2 }, { 0, 1, 1 }, 1 },	// 21
+		{ { 1, 0, 2 }, { 1, 1, 0 }, 1 },	// 22
+		{ { 1, 0, 2 }, { 1, 1, 1 }, 0 },	// 23
+		{ { 2, 0, 1 }, { 0, 0, 0 }, 0 },	// 24
+		{ { 2, 0, 1 }, { 1, 0, 0 }, 1 },	// 25
+		{ { 2, 0, 1 }, { 0, 0, 1 }, 1 },	// 26
+		{ { 2, 0, 1 }, { 1, 0, 1 }, 0 },	// 27
+		{ { 2, 0, 1 }, { 0, 1, 0 }, 1 },	// 28
+		{ { 2, 0, 1 }, { 1, 1, 0 }, 0 },	// 29
+		{ { 2, 0, 1 }, { 0, 1, 1 }, 0 },	// 30
+		{ { 2, 0, 1 }, { 1, 1, 1 }, 1 },	// 31
+		{ { 1, 2, 0 }, { 0, 0, 0 }, 0 },	// 32
+		{ { 1, 2, 0 }, { 0, 1, 0 }, 1 },	// 33
+		{ { 1, 2, 0 }, { 1, 0, 0 }, 1 },	// 34
+		{ { 1, 2, 0 }, { 1, 1, 0 }, 0 },	// 35
+		{ { 1, 2, 0 }, { 0, 0, 1 }, 1 },	// 36
+		{ { 1, 2, 0 }, { 0, 1, 1 }, 0 },	// 37
+		{ { 1, 2, 0 }, { 1, 0, 1 }, 0 },	// 38
+		{ { 1, 2, 0 }, { 1, 1, 1 }, 1 },	// 39
+		{ { 2, 1, 0 }, { 0, 0, 0 }, 1 },	// 40
+		{ { 2, 1, 0 }, { 1, 0, 0 }, 0 },	// 41
+		{ { 2, 1, 0 }, { 0, 1, 0 }, 0 },	// 42
+		{ { 2, 1, 0 }, { 1, 1, 0 }, 1 },	// 43
+		{ { 2, 1, 0 }, { 0, 0, 1 }, 0 },	// 44
+		{ { 2, 1, 0 }, { 1, 0, 1 }, 1 },	// 45
+		{ { 2, 1, 0 }, { 0, 1, 1 }, 1 },	// 46
+		{ { 2, 1, 0 }, { 1, 1, 1 }, 0 },	// 47
+		};
+
+		// Case numbers outside of 0..47 leave the data alone.
+		constexpr bool validCase( int caseNumber )
+		{
+			return static_cast<unsigned int>(caseNumber) < 48u;
+		}
+
+		// 1 or -1, for building the matrix of a case number
+		template <typename T>
+		constexpr T signOf( int negate )
+		{
+			return T(1 - 2 * negate);
+		}
+
+		// Changes the sign of value when negate is 1.  Negating only flips the sign bit, even of
+		// a NaN, so the result is the same as the SIMD kernels give.
+		template <typename T>
+		constexpr T negateIf( T value, int negate )
+		{
+			return negate ? -value : value;
+		}
+
+		// uint16_t holds the bits of an IEEE half float, whose sign is the top bit
+		constexpr uint16_t negateIf( uint16_t value, int negate )
+		{
+			return static_cast<uint16_t>(value ^ (negate << 15));
+		}
+
+		// Integers saturate so the most negative value becomes the most positive one
+		constexpr int16_t negateIf( int16_t value, int negate )
+		{
+			return !negate ? value : (value == INT16_MIN) ? static_cast<int16_t>(INT16_MAX) : static_cast<int16_t>(-value);
+		}
+
+		constexpr int32_t negateIf( int32_t value, int negate )
+		{
+			return !negate ? value : (value == INT32_MIN) ? INT32_MAX : -value;
+		}
+
+		// Same result as negateIf() for the functions that run at run time.  The sign bit of a
+		// float or double is XORed in, so there is no branch on negate to mispredict when the
+		// case number changes from call to call.  Other types use negateIf().
+		template <typename T>
+		inline T changeSign( T value, int negate )
+		{
+			return negateIf( value, negate );
+		}
+
+		inline double changeSign( double value, int negate )
+		{
+			uint64_t bits;
+			memcpy( &bits, &value, sizeof(bits) );
+			bits ^= static_cast<uint64_t>(negate & 1) << 63;
+			memcpy( &value, &bits, sizeof(bits) );
+			return value;
+		}
+
+		inline float changeSign( float value, int negate )
+		{
+			uint32_t bits;
+			memcpy( &bits, &value, sizeof(bits) );
+			bits ^= static_cast<uint32_t>(negate & 1) << 31;
+			memcpy( &value, &bits, sizeof(bits) );
+			return value;
+		}
+
+		// The same logic as getCaseNumber() written so the compiler can evaluate it.
+
+		constexpr bool sameAxis( int from, int to )
+		{
+			return (from & 3) == (to & 3);
+		}
+
+		constexpr int axisOf( const triple &t, int i )
+		{
+			return (i == 0) ? t.a : (i == 1) ? t.b : t.c;
+		}
+
+		// The permutation index P (0 to 5) of the case number
+		constexpr int casePermutation( const triple &from, const triple &to )
+		{
+			return sameAxis( from.a, to.a ) ? (sameAxis( from.b, to.b ) ? 0 : 1) :
+				   sameAxis( from.a, to.b ) ? (sameAxis( from.b, to.a ) ? 2 : 3) :
+											  (sameAxis( from.b, to.a ) ? 4 : 5);
+		}
+
+		// Where the a, b and c axes of the "from" frame end up in the "to" frame for each P
+		constexpr int destinationAxis( int p, int i )
+		{
+			return (p == 0) ? i :
+				   (p == 1) ? ((i == 0) ? 0 : (i == 1) ? 2 : 1) :
+				   (p == 2) ? ((i == 0) ? 1 : (i == 1) ? 0 : 2) :
+				   (p == 3) ? ((i == 0) ? 1 : (i == 1) ? 2 : 0) :
+				   (p == 4) ? ((i == 0) ? 2 : (i == 1) ? 0 : 1) :
+							  ((i == 0) ? 2 : (i == 1) ? 1 : 0);
+		}
+
+		constexpr int caseSigns( const triple &from, const triple &to, int p )
+		{
+			return ((from.a != axisOf( to, destinationAxis( p, 0 ) )) ? 0x04 : 0) |
+				   ((from.b != axisOf( to, destinationAxis( p, 1 ) )) ? 0x02 : 0) |
+				   ((from.c != axisOf( to, destinationAxis( p, 2 ) )) ? 0x01 : 0);
+		}
+
+		constexpr int caseNumber( const triple &from, const triple &to )
+		{
+			return casePermutation( from, to ) * 8 + caseSigns( from, to, casePermutation( from, to ) );
+		}
+
+		// Frame ids.  id = P * 8 + S where P is the order FORWARD, RIGHT and UP appear in
+		// (listed in frameOrders) and S has bit 2, 1 or 0 set when a, b or c is BACK, LEFT or DOWN.
+		constexpr unsigned char frameOrders[6][3] =
+		{
+			{ FORWARD, RIGHT, UP },
+			{ FORWARD, UP, RIGHT },
+			{ RIGHT, FORWARD, UP },
+			{ RIGHT, UP, FORWARD },
+			{ UP, FORWARD, RIGHT },
+			{ UP, RIGHT, FORWARD }
+		};
+
+		constexpr int frameOrder( const triple &frame )
+		{
+			return ((frame.a & 3) == FORWARD) ? (((frame.b & 3) == RIGHT) ? 0 : 1) :
+				   ((frame.a & 3) == RIGHT) ? (((frame.b & 3) == FORWARD) ? 2 : 3) :
+											  (((frame.b & 3) == FORWARD) ? 4 : 5);
+		}
+
+		// One of the six direction constants
+		constexpr bool validDirection( int direction )
+		{
+			return static_cast<unsigned int>(direction) <= 6u && (direction & 3) != 3;
+		}
+
+		// Three directions on three different axes
+		constexpr bool validFrame( const triple &frame )
+		{
+			return validDirection( frame.a ) && validDirection( frame.b ) && validDirection( frame.c ) &&
+				   (frame.a & 3) != (frame.b & 3) && (frame.a & 3) != (frame.c & 3) && (frame.b & 3) != (frame.c & 3);
+		}
+
+		// FRAME_COUNT when the triple isn't a frame
+		constexpr int frameId( const triple &frame )
+		{
+			return !validFrame( frame ) ? FRAME_COUNT :
+				   frameOrder( frame ) * 8 + ((frame.a >> 2) << 2) + ((frame.b >> 2) << 1) + (frame.c >> 2);
+		}
+
+		// ( -1, -1, -1 ), which isn't a frame, when id is FRAME_COUNT or more
+		constexpr triple frameFromId( int id )
+		{
+			return (static_cast<unsigned int>(id) >= static_cast<unsigned int>(FRAME_COUNT)) ? triple( -1, -1, -1 ) : triple(
+				frameOrders[id >> 3][0] | (((id >> 2) & 1) << 2),
+				frameOrders[id >> 3][1] | (((id >> 1) & 1) << 2),
+				frameOrders[id >> 3][2] | ((id & 1) << 2) );
+		}
+
+		// Flipping one axis keeps the sign of the rotation around it and reverses the other two.
+		// The bits are the same as the Euler case number (yaw 4, pitch 2, roll 1).
+		constexpr int eulerAxisFlip( int direction )
+		{
+			return (direction < BACK) ? 0 :
+				   ((direction & 3) == UP) ? 0x03 :
+				   ((direction & 3) == RIGHT) ? 0x05 : 0x06;
+		}
+
+		// The Euler signs that take a frame to (FORWARD, RIGHT, UP).  Reordering the axes
+		// only matters when the order is a reflection, which changes all three signs.
+		// The Euler case number between two frames is the XOR of theirs.
+		constexpr int frameEulerSigns( const triple &frame )
+		{
+			return eulerAxisFlip( frame.a ) ^ eulerAxisFlip( frame.b ) ^ eulerAxisFlip( frame.c ) ^
+				   ((frameOrder( frame ) == 1 || frameOrder( frame ) == 2 || frameOrder( frame ) == 5) ? 0x07 : 0);
+		}
+
+		template <int... I>
+		struct indexList
+		{
+		};
+
+		template <int N, int... I>
+		struct makeIndexList : makeIndexList<N - 1, N - 1, I...>
+		{
+		};
+
+		template <int... I>
+		struct makeIndexList<0, I...>
+		{
+			typedef indexList<I...> type;
+		};
+
+		// Both case numbers from one frame id to every other, so a lookup is one byte load.
+		struct FramePairRow
+		{
+			unsigned char caseNumber[48];
+			unsigned char eulerCaseNumber[48];
+		};
+
+		struct FramePairTable
+		{
+			FramePairRow from[48];
+		};
+
+		template <int... To>
+		constexpr FramePairRow makeFramePairRow( int from, indexList<To...> )
+		{
+			return FramePairRow
+			{
+				{ static_cast<unsigned char>( caseNumber( frameFromId( from ), frameFromId( To ) ) )... },
+				{ static_cast<unsigned char>( frameEulerSigns( frameFromId( from ) ) ^ frameEulerSigns( frameFromId( To ) ) )... }
+			};
+		}
+
+		template <int... From>
+		constexpr FramePairTable makeFramePairTable( indexList<From...> ids )
+		{
+			return FramePairTable{ { makeFramePairRow( From, ids )... } };
+		}
+
+		// Built by the compiler from the same logic as getCaseNumber() and getEulerCaseNumber()
+		constexpr FramePairTable framePairTable = makeFramePairTable( makeIndexList<FRAME_COUNT>::type() );
+
+		// The case numbers are the 48 signed permutations and form a group.  These find the
+		// case number of a signed permutation so products and inverses can be tabled.
+		constexpr bool sameCase( const CaseDescriptor &d, int i0, int i1, int i2, int n0, int n1, int n2 )
+		{
+			return d.index[0] == i0 && d.index[1] == i1 && d.index[2] == i2 &&
+				   d.negate[0] == n0 && d.negate[1] == n1 && d.negate[2] == n2;
+		}
+
+		constexpr int findCase( int i0, int i1, int i2, int n0, int n1, int n2, int caseNumber = 0 )
+		{
+			return (caseNumber >= 48 || sameCase( caseTable[caseNumber], i0, i1, i2, n0, n1, n2 )) ? caseNumber :
+				   findCase( i0, i1, i2, n0, n1, n2, caseNumber + 1 );
+		}
+
+		// [ MAtoC ] = [ MBtoC ] . [ MAtoB ]   is   VC[k] = sign * VA[ indexAtoB[ indexBtoC[k] ] ]
+		constexpr int composeIndex( const CaseDescriptor &AtoB, const CaseDescriptor &BtoC, int k )
+		{
+			return AtoB.index[ BtoC.index[k] ];
+		}
+
+		constexpr int composeNegate( const CaseDescriptor &AtoB, const CaseDescriptor &BtoC, int k )
+		{
+			return BtoC.negate[k] ^ AtoB.negate[ BtoC.index[k] ];
+		}
+
+		constexpr int composeCase( int AtoB, int BtoC )
+		{
+			return findCase(
+				composeIndex( caseTable[AtoB], caseTable[BtoC], 0 ),
+				composeIndex( caseTable[AtoB], caseTable[BtoC], 1 ),
+				composeIndex( caseTable[AtoB], caseTable[BtoC], 2 ),
+				composeNegate( caseTable[AtoB], caseTable[BtoC], 0 ),
+				composeNegate( caseTable[AtoB], caseTable[BtoC], 1 ),
+				composeNegate( caseTable[AtoB], caseTable[BtoC], 2 ) );
+		}
+
+		// MAtoB is orthogonal so its inverse is its transpose.  Output k of the inverse is the
+		// component that landed in input k.
+		constexpr int inverseSlot( const CaseDescriptor &d, int k )
+		{
+			return (d.index[0] == k) ? 0 : (d.index[1] == k) ? 1 : 2;
+		}
+
+		constexpr int inverseCase( int caseNumber )
+		{
+			return findCase(
+				inverseSlot( caseTable[caseNumber], 0 ),
+				inverseSlot( caseTable[caseNumber], 1 ),
+				inverseSlot( caseTable[caseNumber], 2 ),
+				caseTable[caseNumber].negate[ inverseSlot( caseTable[caseNumber], 0 ) ],
+				caseTable[caseNumber].negate[ inverseSlot( caseTable[caseNumber], 1 ) ],
+				caseTable[caseNumber].negate[ inverseSlot( caseTable[caseNumber], 2 ) ] );
+		}
+
+		struct CaseProductRow
+		{
+			unsigned char then[48];
+		};
+
+		struct CaseGroupTable
+		{
+			CaseProductRow compose[48];
+			unsigned char inverse[48];
+		};
+
+		template <int... BtoC>
+		constexpr CaseProductRow makeCaseProductRow( int AtoB, indexList<BtoC...> )
+		{
+			return CaseProductRow{ { static_cast<unsigned char>( composeCase( AtoB, BtoC ) )... } };
+		}
+
+		template <int... Case>
+		constexpr CaseGroupTable makeCaseGroupTable( indexList<Case...> cases )
+		{
+			return CaseGroupTable
+			{
+				{ makeCaseProductRow( Case, cases )... },
+				{ static_cast<unsigned char>( inverseCase( Case ) )... }
+			};
+		}
+
+		constexpr CaseGroupTable caseGroupTable = makeCaseGroupTable( makeIndexList<48>::type() );
+
+		// The components are put in an array so they are picked with a load instead of
+		// a branch, which would be mispredicted when the case number changes a lot.
+		template <typename T>
+		struct Components
+		{
+			T v[3];
+		};
+
+		// VB[k] = sign(negate[k]) * VA[ index[k] ], with every sign flipped when flip is 1
+		template <typename T>
+		constexpr Vector3<T> permuteComponents( const CaseDescriptor &d, const Components<T> &t, int flip )
+		{
+			return Vector3<T>
+			{
+				negateIf( t.v[ d.index[0] ], d.negate[0] ^ flip ),
+				negateIf( t.v[ d.index[1] ], d.negate[1] ^ flip ),
+				negateIf( t.v[ d.index[2] ], d.negate[2] ^ flip )
+			};
+		}
+
+		// The same on separate components in place, for the functions that run at run time
+		template <typename T>
+		inline void permuteInPlace( const CaseDescriptor &d, int flip, T &x, T &y, T &z )
+		{
+			const T t[3] = { x, y, z };
+			x = changeSign( t[ d.index[0] ], d.negate[0] ^ flip );
+			y = changeSign( t[ d.index[1] ], d.negate[1] ^ flip );
+			z = changeSign( t[ d.index[2] ], d.negate[2] ^ flip );
+		}
+
+		template <typename T>
+		constexpr Quaternion<T> withW( const Vector3<T> &v, T w )
+		{
+			return Quaternion<T>{ v.x, v.y, v.z, w };
+		}
+
+		// MB[i][j] = si * sj * MA[ index[i] ][ index[j] ]
+		template <typename T>
+		constexpr T matrixElement( const CaseDescriptor &d, const Matrix3x3<T> &m, int i, int j )
+		{
+			return negateIf( m.m[ d.index[i] ][ d.index[j] ], d.negate[i] ^ d.negate[j] );
+		}
+
+		// Rows and columns of a transform.  0 to 2 are the rotation axes and 3 is the
+		// translation (or the bottom row of a 4x4), which never moves or changes sign.
+		constexpr int transformAxis( const CaseDescriptor &d, int k )
+		{
+			return (k < 3) ? d.index[k] : 3;
+		}
+
+		constexpr int transformSign( const CaseDescriptor &d, int k )
+		{
+			return (k < 3) ? d.negate[k] : 0;
+		}
+
+		// Where row r, column c of a 3x4 transform is stored
+		constexpr int element3x4( int layout, int r, int c )
+		{
+			return (layout == MATRIX_COLUMN_MAJOR) ? c * 3 + r : r * 4 + c;
+		}
+	}
+
+	namespace inlined
+	{
+		// Same as cob::getCaseNumber() but can be evaluated by the compiler
+		constexpr int getCaseNumber( const triple &from, const triple &to )
+		{
+			return detail::caseNumber( from, to );
+		}
+
+		constexpr FrameId getFrameId( const triple &frame )
+		{
+			return static_cast<FrameId>( detail::frameId( frame ) );
+		}
+
+		constexpr triple getFrameFromId( FrameId id )
+		{
+			return detail::frameFromId( id );
+		}
+
+		// The ids must be less than FRAME_COUNT
+		constexpr int getCaseNumber( FrameId from, FrameId to )
+		{
+			return detail::framePairTable.from[from].caseNumber[to];
+		}
+
+		constexpr int getEulerCaseNumber( FrameId from, FrameId to )
+		{
+			return detail::framePairTable.from[from].eulerCaseNumber[to];
+		}
+
+		// 0, which changes nothing, when either triple isn't a frame
+		constexpr int getEulerCaseNumber( const triple &from, const triple &to )
+		{
+			return (detail::frameId( from ) >= FRAME_COUNT || detail::frameId( to ) >= FRAME_COUNT) ? 0 :
+				   detail::framePairTable.from[ detail::frameId( from ) ].eulerCaseNumber[ detail::frameId( to ) ];
+		}
+
+		// The case numbers must be 0 to 47
+		constexpr int composeCase( int AtoB, int BtoC )
+		{
+			return detail::caseGroupTable.compose[AtoB].then[BtoC];
+		}
+
+		constexpr int inverseCase( int caseNumber )
+		{
+			return detail::caseGroupTable.inverse[caseNumber];
+		}
+
+		constexpr bool isReflection( int caseNumber )
+		{
+			return detail::caseTable[caseNumber].reflection != 0;
+		}
+
+		constexpr bool isIdentity( int caseNumber )
+		{
+			return caseNumber == 0;
+		}
+
+		// [ VB ] = [ MAtoB ] . [ VA ]
+		template <typename T>
+		constexpr Vector3<T> vectorCob( int caseNumber, const Vector3<T> &v )
+		{
+			return !detail::validCase( caseNumber ) ? v :
+				detail::permuteComponents( detail::caseTable[caseNumber], detail::Components<T>{ { v.x, v.y, v.z } }, 0 );
+		}
+
+		// Axial vectors (angular velocity, torque, magnetic field) are permuted the same as a
+		// vector but pick up the determinant of MAtoB, so they change sign once more when MAtoB
+		// is a reflection.   [ VB ] = det([ MAtoB ]) [ MAtoB ] . [ VA ]
+		template <typename T>
+		constexpr Vector3<T> pseudoVectorCob( int caseNumber, const Vector3<T> &v )
+		{
+			return !detail::validCase( caseNumber ) ? v :
+				detail::permuteComponents( detail::caseTable[caseNumber], detail::Components<T>{ { v.x, v.y, v.z } }, detail::caseTable[caseNumber].reflection );
+		}
+
+		// qx, qy, qz behave like the axis of the rotation.  They are permuted the same as a
+		// vector but when MAtoB is a reflection all three change sign once more.  qw never changes.
+		template <typename T>
+		constexpr Quaternion<T> quatCob( int caseNumber, const Quaternion<T> &q )
+		{
+			return !detail::validCase( caseNumber ) ? q : detail::withW( detail::permuteComponents(
+				detail::caseTable[caseNumber], detail::Components<T>{ { q.x, q.y, q.z } }, detail::caseTable[caseNumber].reflection ), q.w );
+		}
+
+		// [ MB ] = [ MAtoB ] . [ MA ] . transpose([ MAtoB ])
+		template <typename T>
+		constexpr Matrix3x3<T> matrixCob3x3( int caseNumber, const Matrix3x3<T> &m )
+		{
+			return !detail::validCase( caseNumber ) ? m : Matrix3x3<T>
+			{ {
+				{
+					detail::matrixElement( detail::caseTable[caseNumber], m, 0, 0 ),
+					detail::matrixElement( detail::caseTable[caseNumber], m, 0, 1 ),
+					detail::matrixElement( detail::caseTable[caseNumber], m, 0, 2 )
+				},
+				{
+					detail::matrixElement( detail::caseTable[caseNumber], m, 1, 0 ),
+					detail::matrixElement( detail::caseTable[caseNumber], m, 1, 1 ),
+					detail::matrixElement( detail::caseTable[caseNumber], m, 1, 2 )
+				},
+				{
+					detail::matrixElement( detail::caseTable[caseNumber], m, 2, 0 ),
+					detail::matrixElement( detail::caseTable[caseNumber], m, 2, 1 ),
+					detail::matrixElement( detail::caseTable[caseNumber], m, 2, 2 )
+				}
+			} };
+		}
+
+		// Bit 2 of the Euler case number flips yaw, bit 1 flips pitch and bit 0 flips roll
+		template <typename T>
+		constexpr EulerAngles<T> eulerCob( int eulerCaseNumber, const EulerAngles<T> &e )
+		{
+			return EulerAngles<T>
+			{
+				detail::negateIf( e.yaw, (eulerCaseNumber >> 2) & 1 ),
+				detail::negateIf( e.pitch, (eulerCaseNumber >> 1) & 1 ),
+				detail::negateIf( e.roll, eulerCaseNumber & 1 )
+			};
+		}
+
+		// The same operations on separate components, like the functions in changeOfBasis.h
+
+		// These run at run time, so the signs are changed with detail::changeSign() and the
+		// cost doesn't depend on the case number.
+
+		template <typename T>
+		inline void vectorCob( int caseNumber, T &vx, T &vy, T &vz )
+		{
+			if (!detail::validCase( caseNumber )) return;
+			detail::permuteInPlace( detail::caseTable[caseNumber], 0, vx, vy, vz );
+		}
+
+		template <typename T>
+		inline void pseudoVectorCob( int caseNumber, T &vx, T &vy, T &vz )
+		{
+			if (!detail::validCase( caseNumber )) return;
+			detail::permuteInPlace( detail::caseTable[caseNumber], detail::caseTable[caseNumber].reflection, vx, vy, vz );
+		}
+
+		template <typename T>
+		inline void quatCob( int caseNumber, T &qx, T &qy, T &qz, T &qw )
+		{
+			(void)qw;
+			if (!detail::validCase( caseNumber )) return;
+			detail::permuteInPlace( detail::caseTable[caseNumber], detail::caseTable[caseNumber].reflection, qx, qy, qz );
+		}
+
+		template <typename T>
+		inline void matrixCob3x3( int caseNumber,
+			T &a00, T &a01, T &a02,
+			T &a10, T &a11, T &a12,
+			T &a20, T &a21, T &a22 )
+		{
+			if (!detail::validCase( caseNumber )) return;
+
+			const detail::CaseDescriptor &d = detail::caseTable[caseNumber];
+			const T t[3][3] = { { a00, a01, a02 }, { a10, a11, a12 }, { a20, a21, a22 } };
+			const int i0 = d.index[0], i1 = d.index[1], i2 = d.index[2];
+			const int n0 = d.negate[0], n1 = d.negate[1], n2 = d.negate[2];
+			a00 = detail::changeSign( t[i0][i0], 0 );
+			a01 = detail::changeSign( t[i0][i1], n0 ^ n1 );
+			a02 = detail::changeSign( t[i0][i2], n0 ^ n2 );
+			a10 = detail::changeSign( t[i1][i0], n1 ^ n0 );
+			a11 = detail::changeSign( t[i1][i1], 0 );
+			a12 = detail::changeSign( t[i1][i2], n1 ^ n2 );
+			a20 = detail::changeSign( t[i2][i0], n2 ^ n0 );
+			a21 = detail::changeSign( t[i2][i1], n2 ^ n1 );
+			a22 = detail::changeSign( t[i2][i2], 0 );
+		}
+
+		// [ MB ] = [ P ] . [ MA ] . transpose([ P ]) with P = [ MAtoB 0 ; 0 1 ], on 16 values in
+		// either row-major or column-major order
+		template <typename T>
+		inline void matrixCob4x4( int caseNumber, T *m )
+		{
+			if (!detail::validCase( caseNumber )) return;
+
+			const detail::CaseDescriptor &d = detail::caseTable[caseNumber];
+			const int axis[4] = { d.index[0], d.index[1], d.index[2], 3 };
+			const int sign[4] = { d.negate[0], d.negate[1], d.negate[2], 0 };
+
+			T t[16];
+			for (int k = 0; k < 16; ++k) t[k] = m[k];
+
+			for (int i = 0; i < 4; ++i)
+			{
+				for (int j = 0; j < 4; ++j)
+				{
+					m[i * 4 + j] = detail::changeSign( t[ axis[i] * 4 + axis[j] ], sign[i] ^ sign[j] );
+				}
+			}
+		}
+
+		// [ RB tB ] = [ MAtoB ] . [ RA tA ] . [ P ] on 12 values in the given layout
+		template <typename T>
+		inline void matrixCob3x4( int caseNumber, int layout, T *m )
+		{
+			if (!detail::validCase( caseNumber )) return;
+
+			const detail::CaseDescriptor &d = detail::caseTable[caseNumber];
+			const int axis[4] = { d.index[0], d.index[1], d.index[2], 3 };
+			const int sign[4] = { d.negate[0], d.negate[1], d.negate[2], 0 };
+
+			// Steps between rows and between columns in memory
+			const int rowStep = (layout == MATRIX_COLUMN_MAJOR) ? 1 : 4;
+			const int columnStep = (layout == MATRIX_COLUMN_MAJOR) ? 3 : 1;
+
+			T t[12];
+			for (int k = 0; k < 12; ++k) t[k] = m[k];
+
+			for (int r = 0; r < 3; ++r)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					m[ r * rowStep + c * columnStep ] = detail::changeSign( t[ axis[r] * rowStep + axis[c] * columnStep ], sign[r] ^ sign[c] );
+				}
+			}
+		}
+
+		template <typename T>
+		inline void eulerCob( int eulerCaseNumber, T &yaw, T &pitch, T &roll )
+		{
+			yaw = detail::changeSign( yaw, (eulerCaseNumber >> 2) & 1 );
+			pitch = detail::changeSign( pitch, (eulerCaseNumber >> 1) & 1 );
+			roll = detail::changeSign( roll, eulerCaseNumber & 1 );
+		}
+	}
+}
+
+#endif // CHANGEOFBASIS_INLINE_H
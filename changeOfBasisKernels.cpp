@@ -0,0 +1,1119 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisKernels.h"
+#include "changeOfBasis.h"
+
+#include <string.h>
+
+#if defined(COB_HAVE_AVX2) || defined(COB_HAVE_AVX512)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace cob
+{
+namespace detail
+{
+
+static void setIdentity( int lanes, LanePermutation &p )
+{
+	p.lanes = lanes;
+	for (int k = 0; k < lanes; ++k)
+	{
+		p.index[k] = k;
+		p.negate[k] = false;
+	}
+}
+
+void getVectorPermutation( int caseNumber, LanePermutation &p )
+{
+	setIdentity( 3, p );
+	if (!validCase( caseNumber )) return;
+
+	const CaseDescriptor &d = caseTable[caseNumber];
+	for (int k = 0; k < 3; ++k)
+	{
+		p.index[k] = d.index[k];
+		p.negate[k] = d.negate[k] != 0;
+	}
+}
+
+// Same as a vector with every sign flipped once more for a reflection
+void getPseudoVectorPermutation( int caseNumber, LanePermutation &p )
+{
+	setIdentity( 3, p );
+	if (!validCase( caseNumber )) return;
+
+	const CaseDescriptor &d = caseTable[caseNumber];
+	for (int k = 0; k < 3; ++k)
+	{
+		p.index[k] = d.index[k];
+		p.negate[k] = (d.negate[k] ^ d.reflection) != 0;
+	}
+}
+
+void getQuatPermutation( int caseNumber, int layout, LanePermutation &p )
+{
+	setIdentity( 4, p );
+	if (!validCase( caseNumber )) return;
+
+	// offset of qx within one quaternion.  qw never moves.
+	const int x = (layout == QUAT_WXYZ) ? 1 : 0;
+
+	const CaseDescriptor &d = caseTable[caseNumber];
+	for (int k = 0; k < 3; ++k)
+	{
+		p.index[x + k] = x + d.index[k];
+		p.negate[x + k] = (d.negate[k] ^ d.reflection) != 0;
+	}
+}
+
+// The change of basis with the case number is done as if in Hamilton's convention.  A change
+// of convention on either side is one more sign flip on qx, qy and qz.
+void getQuatPermutation( int caseNumber, const QuatFormat &in, const QuatFormat &out, LanePermutation &p )
+{
+	setIdentity( 4, p );
+
+	// offsets of qx and qw within one quaternion
+	const int inX = (in.layout == QUAT_WXYZ) ? 1 : 0;
+	const int inW = (in.layout == QUAT_WXYZ) ? 0 : 3;
+	const int outX = (out.layout == QUAT_WXYZ) ? 1 : 0;
+	const int outW = (out.layout == QUAT_WXYZ) ? 0 : 3;
+
+	const CaseDescriptor &d = caseTable[validCase( caseNumber ) ? caseNumber : 0];
+	const int conjugate = (in.convention != out.convention) ? 1 : 0;
+	for (int k = 0; k < 3; ++k)
+	{
+		p.index[outX + k] = inX + d.index[k];
+		p.negate[outX + k] = (d.negate[k] ^ d.reflection ^ conjugate) != 0;
+	}
+	p.index[outW] = inW;
+	p.negate[outW] = false;
+}
+
+void getMatrixPermutation( int caseNumber, LanePermutation &p )
+{
+	setIdentity( 9, p );
+	if (!validCase( caseNumber )) return;
+
+	const CaseDescriptor &d = caseTable[caseNumber];
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			p.index[i * 3 + j] = d.index[i] * 3 + d.index[j];
+			p.negate[i * 3 + j] = (d.negate[i] ^ d.negate[j]) != 0;
+		}
+	}
+}
+
+// Element (i, j) of MB is written where outLayout keeps it and read from where inLayout
+// keeps element (index[i], index[j]) of MA
+void getMatrixPermutation( int caseNumber, int inLayout, int outLayout, LanePermutation &p )
+{
+	const bool transposeIn = (inLayout == MATRIX_COLUMN_MAJOR);
+	const bool transposeOut = (outLayout == MATRIX_COLUMN_MAJOR);
+
+	LanePermutation m;
+	getMatrixPermutation( caseNumber, m );
+
+	setIdentity( 9, p );
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			const int from = m.index[i * 3 + j];
+			const int to = transposeOut ? j * 3 + i : i * 3 + j;
+			p.index[to] = transposeIn ? (from % 3) * 3 + from / 3 : from;
+			p.negate[to] = m.negate[i * 3 + j];
+		}
+	}
+}
+
+void getMatrix4x4Permutation( int caseNumber, LanePermutation &p )
+{
+	setIdentity( 16, p );
+	if (!validCase( caseNumber )) return;
+
+	const CaseDescriptor &d = caseTable[caseNumber];
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			p.index[i * 4 + j] = transformAxis( d, i ) * 4 + transformAxis( d, j );
+			p.negate[i * 4 + j] = (transformSign( d, i ) ^ transformSign( d, j )) != 0;
+		}
+	}
+}
+
+void getMatrix3x4Permutation( int caseNumber, int layout, LanePermutation &p )
+{
+	setIdentity( 12, p );
+	if (!validCase( caseNumber )) return;
+
+	const CaseDescriptor &d = caseTable[caseNumber];
+	for (int r = 0; r < 3; ++r)
+	{
+		for (int c = 0; c < 4; ++c)
+		{
+			const int k = element3x4( layout, r, c );
+			p.index[k] = element3x4( layout, transformAxis( d, r ), transformAxis( d, c ) );
+			p.negate[k] = (transformSign( d, r ) ^ transformSign( d, c )) != 0;
+		}
+	}
+}
+
+// Only the signs change.  Bit 2 of the Euler case number is yaw, bit 1 pitch and bit 0 roll.
+void getEulerPermutation( int eulerCaseNumber, LanePermutation &p )
+{
+	setIdentity( 3, p );
+	for (int k = 0; k < 3; ++k)
+	{
+		p.negate[k] = ((eulerCaseNumber >> (2 - k)) & 1) != 0;
+	}
+}
+
+void getImuPermutation( const ImuCob &cob, LanePermutation &p )
+{
+	p.lanes = cob.stride;
+	for (int k = 0; k < cob.stride; ++k)
+	{
+		p.index[k] = cob.index[k];
+		p.negate[k] = cob.negate[k];
+	}
+}
+
+static MixedPermutation buildVectorMixed()
+{
+	MixedPermutation m;
+	for (int e = 0; e < MIXED_ENTRIES; ++e) getVectorPermutation( e, m.entry[e] );
+	return m;
+}
+
+static MixedPermutation buildQuatMixed( int layout )
+{
+	MixedPermutation m;
+	for (int e = 0; e < MIXED_ENTRIES; ++e) getQuatPermutation( e, layout, m.entry[e] );
+	return m;
+}
+
+static MixedPermutation buildMatrixMixed()
+{
+	MixedPermutation m;
+	for (int e = 0; e < MIXED_ENTRIES; ++e) getMatrixPermutation( e, m.entry[e] );
+	return m;
+}
+
+const MixedPermutation &getVectorMixed()
+{
+	static const MixedPermutation m = buildVectorMixed();
+	return m;
+}
+
+const MixedPermutation &getQuatMixed( int layout )
+{
+	static const MixedPermutation xyzw = buildQuatMixed( QUAT_XYZW );
+	static const MixedPermutation wxyz = buildQuatMixed( QUAT_WXYZ );
+	return (layout == QUAT_WXYZ) ? wxyz : xyzw;
+}
+
+const MixedPermutation &getMatrixMixed()
+{
+	static const MixedPermutation m = buildMatrixMixed();
+	return m;
+}
+
+// The scalar kernels move the bits of each lane, so changing the sign of a float or double is
+// an XOR of its sign bit, the same as the SIMD kernels.  The integers saturate instead.
+template <typename T> struct ScalarLane;
+
+template <>
+struct ScalarLane<double>
+{
+	typedef uint64_t Bits;
+	static Bits sign( bool negate ) { return negate ? 0x8000000000000000ULL : 0; }
+	static Bits change( Bits v, Bits sign ) { return v ^ sign; }
+};
+
+template <>
+struct ScalarLane<float>
+{
+	typedef uint32_t Bits;
+	static Bits sign( bool negate ) { return negate ? 0x80000000U : 0; }
+	static Bits change( Bits v, Bits sign ) { return v ^ sign; }
+};
+
+template <>
+struct ScalarLane<uint16_t>
+{
+	typedef uint16_t Bits;
+	static Bits sign( bool negate ) { return negate ? 0x8000U : 0; }
+	static Bits change( Bits v, Bits sign ) { return static_cast<Bits>(v ^ sign); }
+};
+
+template <>
+struct ScalarLane<int16_t>
+{
+	typedef int16_t Bits;
+	static Bits sign( bool negate ) { return negate ? 1 : 0; }
+	static Bits change( Bits v, Bits sign ) { return negateIf( v, sign ); }
+};
+
+template <>
+struct ScalarLane<int32_t>
+{
+	typedef int32_t Bits;
+	static Bits sign( bool negate ) { return negate ? 1 : 0; }
+	static Bits change( Bits v, Bits sign ) { return negateIf( v, sign ); }
+};
+
+// Lane K is read into a register, then the lanes after it, and it is written last, so the
+// whole element is read before any of it is written and src and dst can be the same array.
+// Recursing on K unrolls the element completely so no lane goes through the stack.
+template <int K, int L, typename T>
+struct PermuteLanes
+{
+	typedef typename ScalarLane<T>::Bits Bits;
+
+	static void apply( const int *index, const Bits *sign, const T *src, T *dst )
+	{
+		Bits v;
+		memcpy( &v, src + index[K], sizeof(v) );
+		v = ScalarLane<T>::change( v, sign[K] );
+		PermuteLanes<K + 1, L, T>::apply( index, sign, src, dst );
+		memcpy( dst + K, &v, sizeof(v) );
+	}
+};
+
+template <int L, typename T>
+struct PermuteLanes<L, L, T>
+{
+	static void apply( const int *, const typename ScalarLane<T>::Bits *, const T *, T * ) {}
+};
+
+// One value with its sign changed by a sign from ScalarLane<T>::sign()
+template <typename T>
+static inline T changeSign( T value, typename ScalarLane<T>::Bits sign )
+{
+	typename ScalarLane<T>::Bits v;
+	memcpy( &v, &value, sizeof(v) );
+	v = ScalarLane<T>::change( v, sign );
+	memcpy( &value, &v, sizeof(v) );
+	return value;
+}
+
+template <int L, typename T>
+static void permuteFixed( const LanePermutation &p, const T *src, T *dst, size_t count )
+{
+	int index[L];
+	typename ScalarLane<T>::Bits sign[L];
+	for (int k = 0; k < L; ++k)
+	{
+		index[k] = p.index[k];
+		sign[k] = ScalarLane<T>::sign( p.negate[k] );
+	}
+
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		PermuteLanes<0, L, T>::apply( index, sign, src, dst );
+	}
+}
+
+// Any other element size, such as a sensor record with extra fields
+template <typename T>
+static void permuteAny( const LanePermutation &p, const T *src, T *dst, size_t count )
+{
+	const int L = p.lanes;
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		T t[MAX_LANES];
+		for (int k = 0; k < L; ++k) t[k] = negateIf( src[p.index[k]], p.negate[k] ? 1 : 0 );
+		for (int k = 0; k < L; ++k) dst[k] = t[k];
+	}
+}
+
+template <typename T>
+static void permuteScalar( const LanePermutation &p, const T *src, T *dst, size_t count )
+{
+	switch (p.lanes)
+	{
+		case 3: permuteFixed<3>( p, src, dst, count ); break;
+		case 4: permuteFixed<4>( p, src, dst, count ); break;
+		case 9: permuteFixed<9>( p, src, dst, count ); break;
+		case 12: permuteFixed<12>( p, src, dst, count ); break;
+		case 13: permuteFixed<13>( p, src, dst, count ); break;
+		case 16: permuteFixed<16>( p, src, dst, count ); break;
+		default: permuteAny( p, src, dst, count ); break;
+	}
+}
+
+void permuteBatchScalar( const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	permuteScalar( p, src, dst, count );
+}
+
+void permuteBatchScalar( const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	permuteScalar( p, src, dst, count );
+}
+
+void permuteBatchScalar( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	permuteScalar( p, src, dst, count );
+}
+
+void permuteBatchScalar( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count )
+{
+	permuteScalar( p, src, dst, count );
+}
+
+void permuteBatchScalar( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	permuteScalar( p, src, dst, count );
+}
+
+// Each element looks up its own permutation in a table built on the first block with more
+// than one case number.  The signs are kept as sign bits so an element is only loads, XORs
+// and stores.
+template <int L, typename T>
+struct MixedScalarTable
+{
+	int index[MIXED_ENTRIES][L];
+	typename ScalarLane<T>::Bits sign[MIXED_ENTRIES][L];
+};
+
+template <int L, typename Kernel, typename T>
+static void permuteMixedFixed( Kernel kernel, const MixedPermutation &m, const int *cases, const T *src, T *dst, size_t count )
+{
+	MixedScalarTable<L, T> table;
+	bool built = false;
+
+	for (size_t n = 0; n < count; )
+	{
+		const size_t end = oneCaseEnd( cases, n, count );
+		if (end > n)
+		{
+			kernel( m.entry[mixedEntry( cases[n] )], src + n * L, dst + n * L, end - n );
+			n = end;
+			continue;
+		}
+
+		if (!built)
+		{
+			for (int e = 0; e < MIXED_ENTRIES; ++e)
+			{
+				for (int k = 0; k < L; ++k)
+				{
+					table.index[e][k] = m.entry[e].index[k];
+					table.sign[e][k] = ScalarLane<T>::sign( m.entry[e].negate[k] );
+				}
+			}
+			built = true;
+		}
+
+		const size_t b = (count - n < MIXED_BLOCK) ? count - n : MIXED_BLOCK;
+		const T *s = src + n * L;
+		T *d = dst + n * L;
+		for (size_t i = 0; i < b; ++i, s += L, d += L)
+		{
+			const int e = mixedEntry( cases[n + i] );
+			PermuteLanes<0, L, T>::apply( table.index[e], table.sign[e], s, d );
+		}
+		n += b;
+	}
+}
+
+// Any other element size
+template <typename Kernel, typename T>
+static void permuteMixedAny( Kernel kernel, const MixedPermutation &m, const int *cases, const T *src, T *dst, size_t count )
+{
+	const int L = m.entry[0].lanes;
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		kernel( m.entry[mixedEntry( cases[n] )], src, dst, 1 );
+	}
+}
+
+template <typename Kernel, typename T>
+static void permuteMixedTable( Kernel kernel, const MixedPermutation &m, const int *cases, const T *src, T *dst, size_t count )
+{
+	switch (m.entry[0].lanes)
+	{
+		case 3: permuteMixedFixed<3>( kernel, m, cases, src, dst, count ); break;
+		case 4: permuteMixedFixed<4>( kernel, m, cases, src, dst, count ); break;
+		case 9: permuteMixedFixed<9>( kernel, m, cases, src, dst, count ); break;
+		default: permuteMixedAny( kernel, m, cases, src, dst, count ); break;
+	}
+}
+
+void permuteMixedScalar( PermuteDoubleFn kernel, const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count )
+{
+	permuteMixedTable( kernel, m, cases, src, dst, count );
+}
+
+void permuteMixedScalar( PermuteFloatFn kernel, const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count )
+{
+	permuteMixedTable( kernel, m, cases, src, dst, count );
+}
+
+// CPU feature detection.  A feature is only usable when the CPU has it and the
+// operating system saves the wider registers on a context switch.
+#if defined(COB_HAVE_AVX2) || defined(COB_HAVE_AVX512)
+
+static void cpuid( unsigned int leaf, unsigned int subLeaf, unsigned int regs[4] )
+{
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuidex( r, static_cast<int>(leaf), static_cast<int>(subLeaf) );
+	for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(r[i]);
+#else
+	__cpuid_count( leaf, subLeaf, regs[0], regs[1], regs[2], regs[3] );
+#endif
+}
+
+static unsigned long long xgetbv0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv( 0 );
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__( "xgetbv" : "=a"(eax), "=d"(edx) : "c"(0) );
+	return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+static int detectSimdLevel( bool &avx512bw )
+{
+	unsigned int regs[4];
+	avx512bw = false;
+
+	cpuid( 0, 0, regs );
+	const unsigned int maxLeaf = regs[0];
+	if (maxLeaf < 7) return SIMD_NONE;
+
+	cpuid( 1, 0, regs );
+	const bool osxsave = (regs[2] & (1u << 27)) != 0;
+	const bool avx = (regs[2] & (1u << 28)) != 0;
+	if (!osxsave || !avx) return SIMD_NONE;
+
+	const unsigned long long xcr0 = xgetbv0();
+	const bool ymmSaved = (xcr0 & 0x06) == 0x06;
+	const bool zmmSaved = (xcr0 & 0xE6) == 0xE6;
+
+	cpuid( 7, 0, regs );
+	const bool avx2 = (regs[1] & (1u << 5)) != 0;
+	const bool avx512f = (regs[1] & (1u << 16)) != 0;
+	avx512bw = (regs[1] & (1u << 30)) != 0;
+
+#ifdef COB_HAVE_AVX512
+	if (avx512f && zmmSaved) return SIMD_AVX512;
+#endif
+#ifdef COB_HAVE_AVX2
+	if (avx2 && ymmSaved) return SIMD_AVX2;
+#endif
+	return SIMD_NONE;
+}
+
+// Walks the cache descriptions in leaf 4 (Intel) or 0x8000001D (AMD) for the largest cache.
+static size_t largestCache( unsigned int leaf )
+{
+	size_t largest = 0;
+	for (unsigned int i = 0; i < 16; ++i)
+	{
+		unsigned int regs[4];
+		cpuid( leaf, i, regs );
+		if ((regs[0] & 0x1F) == 0) break;
+
+		const size_t ways = ((regs[1] >> 22) & 0x3FF) + 1;
+		const size_t partitions = ((regs[1] >> 12) & 0x3FF) + 1;
+		const size_t lineSize = (regs[1] & 0xFFF) + 1;
+		const size_t sets = static_cast<size_t>(regs[2]) + 1;
+		const size_t bytes = ways * partitions * lineSize * sets;
+		if (bytes > largest) largest = bytes;
+	}
+	return largest;
+}
+
+static size_t detectLastLevelCache()
+{
+	unsigned int regs[4];
+	cpuid( 0, 0, regs );
+	size_t bytes = (regs[0] >= 4) ? largestCache( 4 ) : 0;
+
+	cpuid( 0x80000000u, 0, regs );
+	if (bytes == 0 && regs[0] >= 0x8000001Du) bytes = largestCache( 0x8000001Du );
+
+	return bytes;
+}
+
+#else
+
+static int detectSimdLevel( bool &avx512bw )
+{
+	avx512bw = false;
+	return SIMD_NONE;
+}
+
+static size_t detectLastLevelCache()
+{
+	return 0;
+}
+
+#endif
+
+static const size_t TYPICAL_LAST_LEVEL_CACHE = 8 * 1024 * 1024;
+
+// These start out as the portable kernels so anything that runs before the library's
+// static initialization still works.  initSimdLevel() switches them to the best
+// kernels once, when the library is loaded.
+static PermuteKernels s_kernels =
+{
+	permuteBatchScalar, permuteBatchScalar, permuteBatchScalar, permuteBatchScalar, permuteBatchScalar
+};
+static int s_maxSimdLevel = SIMD_NONE;
+static bool s_haveAvx512bw = false;
+
+int getPermuteKernels( int level, PermuteKernels &k )
+{
+	if (level > s_maxSimdLevel) level = s_maxSimdLevel;
+	if (level < SIMD_NONE) level = SIMD_NONE;
+
+	switch (level)
+	{
+#ifdef COB_HAVE_AVX512
+		case SIMD_AVX512:
+			k.permuteDouble = permuteBatchAvx512;
+			k.permuteFloat = permuteBatchAvx512;
+			k.permuteInt32 = permuteBatchAvx512;
+			if (s_haveAvx512bw)
+			{
+				k.permuteHalf = permuteBatchAvx512;
+				k.permuteInt16 = permuteBatchAvx512;
+			}
+			else
+			{
+				// Every AVX-512 CPU has AVX2
+				k.permuteHalf = permuteBatchAvx2;
+				k.permuteInt16 = permuteBatchAvx2;
+			}
+			break;
+#endif
+#ifdef COB_HAVE_AVX2
+		case SIMD_AVX2:
+			k.permuteDouble = permuteBatchAvx2;
+			k.permuteFloat = permuteBatchAvx2;
+			k.permuteHalf = permuteBatchAvx2;
+			k.permuteInt16 = permuteBatchAvx2;
+			k.permuteInt32 = permuteBatchAvx2;
+			break;
+#endif
+		default:
+			k.permuteDouble = permuteBatchScalar;
+			k.permuteFloat = permuteBatchScalar;
+			k.permuteHalf = permuteBatchScalar;
+			k.permuteInt16 = permuteBatchScalar;
+			k.permuteInt32 = permuteBatchScalar;
+			level = SIMD_NONE;
+			break;
+	}
+	return level;
+}
+
+int getMaxSimdLevel()
+{
+	return s_maxSimdLevel;
+}
+
+static int initSimdLevel()
+{
+	s_maxSimdLevel = detectSimdLevel( s_haveAvx512bw );
+	return getPermuteKernels( s_maxSimdLevel, s_kernels );
+}
+
+static int s_simdLevel = initSimdLevel();
+
+static size_t initLastLevelCache()
+{
+	const size_t bytes = detectLastLevelCache();
+	return (bytes != 0) ? bytes : TYPICAL_LAST_LEVEL_CACHE;
+}
+
+static size_t s_lastLevelCacheBytes = initLastLevelCache();
+
+const PermuteKernels &getActiveKernels()
+{
+	return s_kernels;
+}
+
+size_t getLastLevelCacheBytes()
+{
+	return s_lastLevelCacheBytes;
+}
+
+// Small enough that the buffer and the source block it came from stay in L1
+static const size_t STREAM_BLOCK_BYTES = 8 * 1024;
+
+// SSE2 has non-temporal stores but no streaming loads, which came with SSE4.1
+static bool haveStreamStores()
+{
+#ifdef COB_HAVE_SSE2
+	return true;
+#elif defined(COB_HAVE_AVX2)
+	return s_maxSimdLevel >= SIMD_AVX2;
+#else
+	return false;
+#endif
+}
+
+static bool haveStreamLoads()
+{
+#ifdef COB_HAVE_AVX2
+	return s_maxSimdLevel >= SIMD_AVX2;
+#else
+	return false;
+#endif
+}
+
+// Non-temporal stores with the widest registers the CPU has.  Only when haveStreamStores().
+static void streamCopy( void *dst, const void *src, size_t bytes )
+{
+#ifdef COB_HAVE_AVX2
+	if (s_maxSimdLevel >= SIMD_AVX2)
+	{
+		streamCopyAvx2( dst, src, bytes );
+		return;
+	}
+#endif
+#ifdef COB_HAVE_SSE2
+	streamCopySse2( dst, src, bytes );
+#else
+	memcpy( dst, src, bytes );
+#endif
+}
+
+// Only when haveStreamLoads()
+static void streamLoad( void *dst, const void *src, size_t bytes )
+{
+#ifdef COB_HAVE_AVX2
+	streamLoadAvx2( dst, src, bytes );
+#else
+	memcpy( dst, src, bytes );
+#endif
+}
+
+// Non-temporal stores aren't ordered with other stores until this
+static void streamFence()
+{
+#ifdef COB_HAVE_AVX2
+	if (s_maxSimdLevel >= SIMD_AVX2)
+	{
+		streamFenceAvx2();
+		return;
+	}
+#endif
+#ifdef COB_HAVE_SSE2
+	streamFenceSse2();
+#endif
+}
+
+template <typename Kernel, typename T>
+static void permuteStream( Kernel kernel, const LanePermutation &p, const T *src, T *dst, size_t count, bool streamLoads, bool streamStores )
+{
+	streamLoads = streamLoads && haveStreamLoads();
+	streamStores = streamStores && haveStreamStores();
+	if (!streamLoads && !streamStores)
+	{
+		kernel( p, src, dst, count );
+		return;
+	}
+
+	// A multiple of 32 elements is a multiple of 64 bytes, so every block lines up with
+	// the cache lines the same way as the first one
+	const size_t L = p.lanes;
+	const size_t block = (STREAM_BLOCK_BYTES / (L * sizeof(T))) & ~static_cast<size_t>(31);
+
+	T buffer[STREAM_BLOCK_BYTES / sizeof(T)];
+	T loaded[STREAM_BLOCK_BYTES / sizeof(T)];
+	for (size_t n = 0; n < count; n += block)
+	{
+		const size_t m = (count - n < block) ? count - n : block;
+		const T *s = src + n * L;
+		if (streamLoads)
+		{
+			streamLoad( loaded, s, m * L * sizeof(T) );
+			s = loaded;
+		}
+
+		if (streamStores)
+		{
+			kernel( p, s, buffer, m );
+			streamCopy( dst + n * L, buffer, m * L * sizeof(T) );
+		}
+		else
+		{
+			kernel( p, s, dst + n * L, m );
+		}
+	}
+
+	if (streamStores) streamFence();
+}
+
+void permuteBatchStream( PermuteDoubleFn kernel, const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	permuteStream( kernel, p, src, dst, count, false, true );
+}
+
+void permuteBatchStream( PermuteFloatFn kernel, const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	permuteStream( kernel, p, src, dst, count, false, true );
+}
+
+void permuteBatchStream( PermuteHalfFn kernel, const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	permuteStream( kernel, p, src, dst, count, false, true );
+}
+
+void permuteBatchStream( PermuteInt16Fn kernel, const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count )
+{
+	permuteStream( kernel, p, src, dst, count, false, true );
+}
+
+void permuteBatchStream( PermuteInt32Fn kernel, const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	permuteStream( kernel, p, src, dst, count, false, true );
+}
+
+void permuteStreamLoad( PermuteDoubleFn kernel, const LanePermutation &p, const double *src, double *dst, size_t count, bool streamStores )
+{
+	permuteStream( kernel, p, src, dst, count, true, streamStores );
+}
+
+void permuteStreamLoad( PermuteFloatFn kernel, const LanePermutation &p, const float *src, float *dst, size_t count, bool streamStores )
+{
+	permuteStream( kernel, p, src, dst, count, true, streamStores );
+}
+
+void permuteStreamLoad( PermuteHalfFn kernel, const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count, bool streamStores )
+{
+	permuteStream( kernel, p, src, dst, count, true, streamStores );
+}
+
+void permuteStreamLoad( PermuteInt16Fn kernel, const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count, bool streamStores )
+{
+	permuteStream( kernel, p, src, dst, count, true, streamStores );
+}
+
+void permuteStreamLoad( PermuteInt32Fn kernel, const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count, bool streamStores )
+{
+	permuteStream( kernel, p, src, dst, count, true, streamStores );
+}
+
+void permuteBatch( const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	s_kernels.permuteDouble( p, src, dst, count );
+}
+
+void permuteBatch( const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	s_kernels.permuteFloat( p, src, dst, count );
+}
+
+void permuteBatch( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	s_kernels.permuteHalf( p, src, dst, count );
+}
+
+void permuteBatch( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count )
+{
+	s_kernels.permuteInt16( p, src, dst, count );
+}
+
+void permuteBatch( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	s_kernels.permuteInt32( p, src, dst, count );
+}
+
+void permuteMixed( const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteMixedAvx512( s_kernels.permuteDouble, m, cases, src, dst, count );
+		return;
+	}
+#endif
+#ifdef COB_HAVE_AVX2
+	if (s_simdLevel >= SIMD_AVX2)
+	{
+		permuteMixedAvx2( s_kernels.permuteDouble, m, cases, src, dst, count );
+		return;
+	}
+#endif
+	permuteMixedScalar( s_kernels.permuteDouble, m, cases, src, dst, count );
+}
+
+void permuteMixed( const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteMixedAvx512( s_kernels.permuteFloat, m, cases, src, dst, count );
+		return;
+	}
+#endif
+#ifdef COB_HAVE_AVX2
+	if (s_simdLevel >= SIMD_AVX2)
+	{
+		permuteMixedAvx2( s_kernels.permuteFloat, m, cases, src, dst, count );
+		return;
+	}
+#endif
+	permuteMixedScalar( s_kernels.permuteFloat, m, cases, src, dst, count );
+}
+
+// Fields are gathered a block at a time into a packed buffer in L1, converted there by the
+// ordinary kernel and scattered back.  The copies are a fixed size for the common elements so
+// they compile to a few moves.
+template <int L, typename T>
+static void copyField( T *dst, const T *src )
+{
+	memcpy( dst, src, L * sizeof(T) );
+}
+
+template <int L, typename Kernel, typename T>
+static void permuteStridedFixed( Kernel kernel, const LanePermutation &p, const T *src, size_t srcStride, T *dst, size_t dstStride, size_t count )
+{
+	// Separate buffers so the kernel runs out of place and doesn't copy the block again
+	T gathered[STRIDED_BLOCK * L];
+	T converted[STRIDED_BLOCK * L];
+	const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
+	unsigned char *d = reinterpret_cast<unsigned char *>(dst);
+
+	for (size_t n = 0; n < count; n += STRIDED_BLOCK)
+	{
+		const size_t b = (count - n < STRIDED_BLOCK) ? count - n : STRIDED_BLOCK;
+		for (size_t i = 0; i < b; ++i, s += srcStride)
+		{
+			copyField<L>( gathered + i * L, reinterpret_cast<const T *>(s) );
+		}
+
+		kernel( p, gathered, converted, b );
+
+		for (size_t i = 0; i < b; ++i, d += dstStride)
+		{
+			copyField<L>( reinterpret_cast<T *>(d), converted + i * L );
+		}
+	}
+}
+
+// Any other element size
+template <typename Kernel, typename T>
+static void permuteStridedAny( Kernel kernel, const LanePermutation &p, const T *src, size_t srcStride, T *dst, size_t dstStride, size_t count )
+{
+	T buffer[MAX_LANES];
+	const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
+	unsigned char *d = reinterpret_cast<unsigned char *>(dst);
+
+	for (size_t n = 0; n < count; ++n, s += srcStride, d += dstStride)
+	{
+		memcpy( buffer, s, p.lanes * sizeof(T) );
+		kernel( p, buffer, buffer, 1 );
+		memcpy( d, buffer, p.lanes * sizeof(T) );
+	}
+}
+
+template <typename Kernel, typename T>
+static void permuteStridedBlocks( Kernel kernel, const LanePermutation &p, const T *src, size_t srcStride, T *dst, size_t dstStride, size_t count )
+{
+	switch (p.lanes)
+	{
+		case 3: permuteStridedFixed<3>( kernel, p, src, srcStride, dst, dstStride, count ); break;
+		case 4: permuteStridedFixed<4>( kernel, p, src, srcStride, dst, dstStride, count ); break;
+		case 9: permuteStridedFixed<9>( kernel, p, src, srcStride, dst, dstStride, count ); break;
+		default: permuteStridedAny( kernel, p, src, srcStride, dst, dstStride, count ); break;
+	}
+}
+
+void permuteStrided( const LanePermutation &p, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteStridedAvx512( p, src, srcStride, dst, dstStride, count );
+		return;
+	}
+#endif
+	permuteStridedBlocks( s_kernels.permuteDouble, p, src, srcStride, dst, dstStride, count );
+}
+
+void permuteStrided( const LanePermutation &p, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteStridedAvx512( p, src, srcStride, dst, dstStride, count );
+		return;
+	}
+#endif
+	permuteStridedBlocks( s_kernels.permuteFloat, p, src, srcStride, dst, dstStride, count );
+}
+
+// Element n of the packed array is lanes n * L to n * L + L - 1, and of the component arrays
+// is entry n of each.  The lane count is a template parameter so each element unrolls and the
+// signs are sign bits.
+template <int L, typename T>
+static void permuteToSoAFixed( const LanePermutation &p, const T *src, T *const *dst, size_t count )
+{
+	int index[L];
+	typename ScalarLane<T>::Bits sign[L];
+	T *out[L];
+	for (int k = 0; k < L; ++k)
+	{
+		index[k] = p.index[k];
+		sign[k] = ScalarLane<T>::sign( p.negate[k] );
+		out[k] = dst[k];
+	}
+
+	for (size_t n = 0; n < count; ++n, src += L)
+	{
+		for (int k = 0; k < L; ++k) out[k][n] = changeSign( src[index[k]], sign[k] );
+	}
+}
+
+template <int L, typename T>
+static void permuteFromSoAFixed( const LanePermutation &p, const T *const *src, T *dst, size_t count )
+{
+	typename ScalarLane<T>::Bits sign[L];
+	const T *in[L];
+	for (int k = 0; k < L; ++k)
+	{
+		sign[k] = ScalarLane<T>::sign( p.negate[k] );
+		in[k] = src[p.index[k]];
+	}
+
+	for (size_t n = 0; n < count; ++n, dst += L)
+	{
+		for (int k = 0; k < L; ++k) dst[k] = changeSign( in[k][n], sign[k] );
+	}
+}
+
+template <typename T>
+static void permuteToSoATable( const LanePermutation &p, const T *src, T *const *dst, size_t count )
+{
+	if (p.lanes == 3) permuteToSoAFixed<3>( p, src, dst, count );
+	else permuteToSoAFixed<4>( p, src, dst, count );
+}
+
+template <typename T>
+static void permuteFromSoATable( const LanePermutation &p, const T *const *src, T *dst, size_t count )
+{
+	if (p.lanes == 3) permuteFromSoAFixed<3>( p, src, dst, count );
+	else permuteFromSoAFixed<4>( p, src, dst, count );
+}
+
+void permuteToSoA( const LanePermutation &p, const double *src, double *const *dst, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteToSoAAvx512( p, src, dst, count );
+		return;
+	}
+#endif
+	permuteToSoATable( p, src, dst, count );
+}
+
+void permuteToSoA( const LanePermutation &p, const float *src, float *const *dst, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteToSoAAvx512( p, src, dst, count );
+		return;
+	}
+#endif
+	permuteToSoATable( p, src, dst, count );
+}
+
+void permuteFromSoA( const LanePermutation &p, const double *const *src, double *dst, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteFromSoAAvx512( p, src, dst, count );
+		return;
+	}
+#endif
+	permuteFromSoATable( p, src, dst, count );
+}
+
+void permuteFromSoA( const LanePermutation &p, const float *const *src, float *dst, size_t count )
+{
+#ifdef COB_HAVE_AVX512
+	if (s_simdLevel >= SIMD_AVX512)
+	{
+		permuteFromSoAAvx512( p, src, dst, count );
+		return;
+	}
+#endif
+	permuteFromSoATable( p, src, dst, count );
+}
+
+// The component arrays are reordered by swapping pointers.  Each array moves to exactly one
+// place, so the ones that change sign can be negated where they are.
+template <typename T>
+static void permuteSoAPointers( const LanePermutation &p, T **arrays, size_t count )
+{
+	LanePermutation negate;
+	negate.lanes = 1;
+	negate.index[0] = 0;
+	negate.negate[0] = true;
+
+	T *moved[MAX_LANES];
+	for (int k = 0; k < p.lanes; ++k)
+	{
+		moved[k] = arrays[p.index[k]];
+		if (p.negate[k]) permuteBatch( negate, moved[k], moved[k], count );
+	}
+	for (int k = 0; k < p.lanes; ++k) arrays[k] = moved[k];
+}
+
+void permuteSoA( const LanePermutation &p, double **arrays, size_t count )
+{
+	permuteSoAPointers( p, arrays, count );
+}
+
+void permuteSoA( const LanePermutation &p, float **arrays, size_t count )
+{
+	permuteSoAPointers( p, arrays, count );
+}
+
+} // namespace detail
+
+int getSimdLevel()
+{
+	return detail::s_simdLevel;
+}
+
+int setSimdLevel( int level )
+{
+	detail::s_simdLevel = detail::getPermuteKernels( level, detail::s_kernels );
+	return detail::s_simdLevel;
+}
+
+} // namespace cob
@@ -0,0 +1,268 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef CHANGEOFBASIS_KERNELS_H
+#define	CHANGEOFBASIS_KERNELS_H
+
+#include <stddef.h>
+#include "changeOfBasisInline.h"
+
+// Internal to the change of basis.  You don't need to include this.
+//
+// Every change of basis on a vector, quaternion or matrix is a signed permutation of
+// its components.  The batch functions turn the case number into a LanePermutation
+// once and then hand it to one of the kernels below, which apply it to a whole array.
+
+// SIMD kernels are built with per-function target attributes so no special compiler
+// flags are needed.  Define COB_NO_SIMD to build only the portable kernels.
+#if !defined(COB_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+	#if defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1700)
+		#define COB_HAVE_AVX2 1
+	#endif
+	#if defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1910)
+		#define COB_HAVE_AVX512 1
+	#endif
+	// Every x86-64 CPU has SSE2, so it needs no check at run time
+	#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define COB_HAVE_SSE2 1
+	#endif
+#endif
+
+#if defined(__GNUC__)
+	#define COB_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define COB_TARGET(isa)
+#endif
+
+namespace cob
+{
+namespace detail
+{
+	// Enough for a whole sensor record (see ImuCob)
+	const int MAX_LANES = 16;
+
+	// out[k] = in[index[k]] with the sign changed when negate[k] is set.
+	// An element is the group of lanes that make up one vector, quaternion, matrix or record.
+	struct LanePermutation
+	{
+		int lanes;
+		int index[MAX_LANES];
+		bool negate[MAX_LANES];
+	};
+
+	// These are built from caseTable in changeOfBasisInline.h.
+	void getVectorPermutation( int caseNumber, LanePermutation &p );
+	void getPseudoVectorPermutation( int caseNumber, LanePermutation &p );
+	void getQuatPermutation( int caseNumber, int layout, LanePermutation &p );
+	void getQuatPermutation( int caseNumber, const QuatFormat &in, const QuatFormat &out, LanePermutation &p );
+	void getMatrixPermutation( int caseNumber, LanePermutation &p );
+	void getMatrixPermutation( int caseNumber, int inLayout, int outLayout, LanePermutation &p );
+	void getMatrix4x4Permutation( int caseNumber, LanePermutation &p );
+	void getMatrix3x4Permutation( int caseNumber, int layout, LanePermutation &p );
+
+	// Sign changes only, from the bits of the Euler case number
+	void getEulerPermutation( int eulerCaseNumber, LanePermutation &p );
+
+	// One permutation for a whole IMU sample
+	void getImuPermutation( const ImuCob &cob, LanePermutation &p );
+
+	// Applies p to count elements.  src and dst are either the same array or do not overlap.
+	// uint16_t is an IEEE half float.  The integer types saturate when their sign changes.
+	void permuteBatch( const LanePermutation &p, const double *src, double *dst, size_t count );
+	void permuteBatch( const LanePermutation &p, const float *src, float *dst, size_t count );
+	void permuteBatch( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count );
+	void permuteBatch( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count );
+	void permuteBatch( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count );
+
+	// A permutation for every case number, for batches with a case number per element.  The
+	// last entry is the identity, which is used for case numbers out of range.
+	const int MIXED_ENTRIES = 49;
+
+	struct MixedPermutation
+	{
+		LanePermutation entry[MIXED_ENTRIES];
+	};
+
+	inline int mixedEntry( int caseNumber )
+	{
+		return validCase( caseNumber ) ? caseNumber : MIXED_ENTRIES - 1;
+	}
+
+	// The permutations for every case number, built once
+	const MixedPermutation &getVectorMixed();
+	const MixedPermutation &getQuatMixed( int layout );
+	const MixedPermutation &getMatrixMixed();
+
+	// Case numbers are looked at this many elements at a time.  Runs of blocks with one case
+	// number go through the ordinary kernel and any other block looks up each element's
+	// permutation.
+	const size_t MIXED_BLOCK = 64;
+
+	inline bool isOneCase( const int *cases, size_t count )
+	{
+		// No early out, so this is a few SIMD compares instead of a branch per element
+		int differ = 0;
+		for (size_t i = 1; i < count; ++i) differ |= cases[i] ^ cases[0];
+		return differ == 0;
+	}
+
+	// The end of the run of whole blocks from n on that only have the case number cases[n].
+	// n when the block at n has more than one.
+	inline size_t oneCaseEnd( const int *cases, size_t n, size_t count )
+	{
+		size_t end = n;
+		while (end < count)
+		{
+			const size_t b = (count - end < MIXED_BLOCK) ? count - end : MIXED_BLOCK;
+			if (cases[end] != cases[n] || !isOneCase( cases + end, b )) break;
+			end += b;
+		}
+		return end;
+	}
+
+	// Applies m.entry[mixedEntry( cases[n] )] to element n.  src and dst are either the same
+	// array or do not overlap.
+	void permuteMixed( const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count );
+	void permuteMixed( const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count );
+
+	// Elements converted at a time by the strided functions
+	const size_t STRIDED_BLOCK = 64;
+
+	// Applies p to count elements that are srcStride bytes apart in src and dstStride bytes
+	// apart in dst, which need not be aligned.  src and dst are either the same array with the
+	// same stride or do not overlap.
+	void permuteStrided( const LanePermutation &p, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count );
+	void permuteStrided( const LanePermutation &p, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count );
+
+	// Applies p to count packed elements of 3 or 4 lanes and writes lane k of each to the array
+	// dst[k], or the reverse.  src and dst must not overlap.
+	void permuteToSoA( const LanePermutation &p, const double *src, double *const *dst, size_t count );
+	void permuteToSoA( const LanePermutation &p, const float *src, float *const *dst, size_t count );
+	void permuteFromSoA( const LanePermutation &p, const double *const *src, double *dst, size_t count );
+	void permuteFromSoA( const LanePermutation &p, const float *const *src, float *dst, size_t count );
+
+	// Applies p to p.lanes component arrays of count entries by reordering the pointers and
+	// negating the arrays that change sign.  The other arrays aren't read or written.
+	void permuteSoA( const LanePermutation &p, double **arrays, size_t count );
+	void permuteSoA( const LanePermutation &p, float **arrays, size_t count );
+
+	typedef void (*PermuteDoubleFn)( const LanePermutation &, const double *, double *, size_t );
+	typedef void (*PermuteFloatFn)( const LanePermutation &, const float *, float *, size_t );
+	typedef void (*PermuteHalfFn)( const LanePermutation &, const uint16_t *, uint16_t *, size_t );
+	typedef void (*PermuteInt16Fn)( const LanePermutation &, const int16_t *, int16_t *, size_t );
+	typedef void (*PermuteInt32Fn)( const LanePermutation &, const int32_t *, int32_t *, size_t );
+
+	// The kernel for each scalar type at one SIMD level
+	struct PermuteKernels
+	{
+		PermuteDoubleFn permuteDouble;
+		PermuteFloatFn permuteFloat;
+		PermuteHalfFn permuteHalf;
+		PermuteInt16Fn permuteInt16;
+		PermuteInt32Fn permuteInt32;
+	};
+
+	// Sets k to the kernels for a SIMD level, clamped to what the CPU supports.  Returns the
+	// level used.  permuteBatch() uses the kernels for the level from setSimdLevel().
+	int getPermuteKernels( int level, PermuteKernels &k );
+
+	// The best SIMD level the CPU supports
+	int getMaxSimdLevel();
+
+	// The kernels permuteBatch() is using
+	const PermuteKernels &getActiveKernels();
+
+	// Same as kernel( p, src, dst, count ) but dst is written with non-temporal stores so a
+	// large output doesn't push everything else out of the caches or read dst in first.  Each
+	// block is permuted into a buffer that stays in L1 and then streamed out, 32 bytes at a time
+	// with AVX2 and 16 with SSE2.  Without either this is just the kernel.  src and dst must not
+	// overlap.
+	void permuteBatchStream( PermuteDoubleFn kernel, const LanePermutation &p, const double *src, double *dst, size_t count );
+	void permuteBatchStream( PermuteFloatFn kernel, const LanePermutation &p, const float *src, float *dst, size_t count );
+	void permuteBatchStream( PermuteHalfFn kernel, const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count );
+	void permuteBatchStream( PermuteInt16Fn kernel, const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count );
+	void permuteBatchStream( PermuteInt32Fn kernel, const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count );
+
+	// Same as kernel( p, src, dst, count ) but src is read with streaming loads, which is the
+	// only fast way to read write-combining memory (ex. a buffer a device DMAs into through a
+	// mapped PCIe BAR).  On ordinary memory they are plain loads.  With streamStores dst is
+	// written as in permuteBatchStream().  SSE2 has no streaming loads (they came with SSE4.1),
+	// so without AVX2 src is read with plain loads.  src and dst must not overlap.
+	void permuteStreamLoad( PermuteDoubleFn kernel, const LanePermutation &p, const double *src, double *dst, size_t count, bool streamStores );
+	void permuteStreamLoad( PermuteFloatFn kernel, const LanePermutation &p, const float *src, float *dst, size_t count, bool streamStores );
+	void permuteStreamLoad( PermuteHalfFn kernel, const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count, bool streamStores );
+	void permuteStreamLoad( PermuteInt16Fn kernel, const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count, bool streamStores );
+	void permuteStreamLoad( PermuteInt32Fn kernel, const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count, bool streamStores );
+
+	// The size of the largest cache, or a typical size when the CPU doesn't say
+	size_t getLastLevelCacheBytes();
+
+	void permuteBatchScalar( const LanePermutation &p, const double *src, double *dst, size_t count );
+	void permuteBatchScalar( const LanePermutation &p, const float *src, float *dst, size_t count );
+	void permuteBatchScalar( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count );
+	void permuteBatchScalar( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count );
+	void permuteBatchScalar( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count );
+
+#ifdef COB_HAVE_AVX2
+	void permuteBatchAvx2( const LanePermutation &p, const double *src, double *dst, size_t count );
+	void permuteBatchAvx2( const LanePermutation &p, const float *src, float *dst, size_t count );
+	void permuteBatchAvx2( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count );
+	void permuteBatchAvx2( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count );
+	void permuteBatchAvx2( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count );
+#endif
+
+	// The mixed kernels.  kernel is used for blocks with only one case number.
+	void permuteMixedScalar( PermuteDoubleFn kernel, const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count );
+	void permuteMixedScalar( PermuteFloatFn kernel, const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count );
+
+#ifdef COB_HAVE_AVX2
+	void permuteMixedAvx2( PermuteDoubleFn kernel, const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count );
+	void permuteMixedAvx2( PermuteFloatFn kernel, const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count );
+#endif
+
+#ifdef COB_HAVE_AVX2
+	void streamCopyAvx2( void *dst, const void *src, size_t bytes );
+	void streamLoadAvx2( void *dst, const void *src, size_t bytes );
+	void streamFenceAvx2();
+#endif
+
+#ifdef COB_HAVE_SSE2
+	void streamCopySse2( void *dst, const void *src, size_t bytes );
+	void streamFenceSse2();
+#endif
+
+#ifdef COB_HAVE_AVX512
+	void permuteBatchAvx512( const LanePermutation &p, const double *src, double *dst, size_t count );
+	void permuteBatchAvx512( const LanePermutation &p, const float *src, float *dst, size_t count );
+	void permuteBatchAvx512( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count );
+
+	// 16 bit lanes need AVX-512BW as well
+	void permuteBatchAvx512( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count );
+	void permuteBatchAvx512( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count );
+
+	void permuteMixedAvx512( PermuteDoubleFn kernel, const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count );
+	void permuteMixedAvx512( PermuteFloatFn kernel, const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count );
+	void permuteStridedAvx512( const LanePermutation &p, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count );
+	void permuteStridedAvx512( const LanePermutation &p, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count );
+	void permuteToSoAAvx512( const LanePermutation &p, const double *src, double *const *dst, size_t count );
+	void permuteToSoAAvx512( const LanePermutation &p, const float *src, float *const *dst, size_t count );
+	void permuteFromSoAAvx512( const LanePermutation &p, const double *const *src, double *dst, size_t count );
+	void permuteFromSoAAvx512( const LanePermutation &p, const float *const *src, float *dst, size_t count );
+#endif
+}
+}
+
+#endif // CHANGEOFBASIS_KERNELS_H
@@ -0,0 +1,137 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisLazy.h"
+
+namespace cob
+{
+namespace detail
+{
+
+// The frame caseNumber takes from to.  Case number P * 8 + S moves axis i of from to
+// destinationAxis( P, i ) and reverses it when bit 2 - i of S is set.
+static FrameId frameAfter( FrameId from, int caseNumber )
+{
+	const triple f = getFrameFromId( from );
+	const int p = caseNumber >> 3;
+	int to[3];
+	to[destinationAxis( p, 0 )] = f.a ^ ((caseNumber & 0x04) ? BACK : 0);
+	to[destinationAxis( p, 1 )] = f.b ^ ((caseNumber & 0x02) ? BACK : 0);
+	to[destinationAxis( p, 2 )] = f.c ^ ((caseNumber & 0x01) ? BACK : 0);
+	return getFrameId( triple( to[0], to[1], to[2] ) );
+}
+
+} // namespace detail
+
+template <typename T>
+LazyArray<T>::LazyArray( T *data, size_t count, int element, int layout, FrameId frame )
+	: m_data( data ), m_count( 0 ), m_element( element ), m_layout( layout ), m_frame( 0 ), m_target( 0 ), m_case( 0 ), m_valid( false )
+{
+	m_permutation.lanes = 0;
+	if (frame >= FRAME_COUNT || (data == NULL && count > 0)) return;
+
+	// Any case number works to check the element and layout
+	if (!detail::getElementPermutation( element, 0, layout, m_permutation )) return;
+
+	m_count = count;
+	m_frame = frame;
+	m_target = frame;
+	m_case = getCaseNumber( frame, frame );
+	m_valid = true;
+	update();
+}
+
+template <typename T>
+bool LazyArray<T>::isValid() const
+{
+	return m_valid;
+}
+
+template <typename T>
+size_t LazyArray<T>::size() const
+{
+	return m_count;
+}
+
+template <typename T>
+int LazyArray<T>::getLanes() const
+{
+	return m_permutation.lanes;
+}
+
+template <typename T>
+FrameId LazyArray<T>::getStoredFrame() const
+{
+	return m_frame;
+}
+
+template <typename T>
+FrameId LazyArray<T>::getFrame() const
+{
+	return m_target;
+}
+
+template <typename T>
+int LazyArray<T>::getPendingCase() const
+{
+	return m_case;
+}
+
+template <typename T>
+void LazyArray<T>::retarget( FrameId to )
+{
+	if (!m_valid || to >= FRAME_COUNT) return;
+
+	m_target = to;
+	m_case = getCaseNumber( m_frame, to );
+	update();
+}
+
+template <typename T>
+void LazyArray<T>::convert( int caseNumber )
+{
+	if (!m_valid || !detail::validCase( caseNumber )) return;
+
+	m_target = detail::frameAfter( m_target, caseNumber );
+	m_case = composeCase( m_case, caseNumber );
+	update();
+}
+
+template <typename T>
+void LazyArray<T>::materialize()
+{
+	if (!m_valid || isIdentity( m_case )) return;
+
+	detail::permuteBatch( m_permutation, m_data, m_data, m_count );
+	m_frame = m_target;
+	m_case = getCaseNumber( m_frame, m_frame );
+	update();
+}
+
+template <typename T>
+void LazyArray<T>::update()
+{
+	// Euler angles have their own case numbers.  One is the XOR of the Euler signs of the two
+	// frames, so it is looked up from the stored and target frames rather than from m_case.
+	const int caseNumber = (m_element == ELEMENT_EULER) ? getEulerCaseNumber( m_frame, m_target ) : m_case;
+	detail::getElementPermutation( m_element, caseNumber, m_layout, m_permutation );
+}
+
+template class LazyArray<double>;
+template class LazyArray<float>;
+template class LazyArray<uint16_t>;
+template class LazyArray<int16_t>;
+template class LazyArray<int32_t>;
+
+} // namespace cob
@@ -0,0 +1,147 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef CHANGEOFBASIS_LAZY_H
+#define	CHANGEOFBASIS_LAZY_H
+
+#include "changeOfBasisPlan.h"
+
+#include <iterator>
+
+// Lazy conversions for data that is often converted and then never read, or converted
+// several times in a row.  A LazyArray is a view of your elements that remembers the frame
+// they are stored in and the frame you want to read them in.  Changing the frame only
+// composes case numbers and never touches the elements.  The conversion happens when
+// elements are read, one at a time through get() or the iterators, or all at once with
+// materialize(), which runs the batch kernel over the array a single time.
+//
+// example:
+//   cob::LazyArray<float> poses( quats, count, cob::ELEMENT_QUAT, cob::QUAT_XYZW, sensorFrame );
+//   poses.retarget( rigFrame );
+//   poses.convert( rigToEngine );			// still nothing converted
+//   for (auto it = poses.begin(); it != poses.end(); ++it) draw( (*it)[0], (*it)[1], (*it)[2], (*it)[3] );
+//
+// LazyArray<T> is provided for double, float, uint16_t (half floats), int16_t and int32_t.
+
+namespace cob
+{
+	template <typename T>
+	class LazyArray
+	{
+	public:
+		// One converted element, returned by value
+		struct Element
+		{
+			T value[detail::MAX_LANES];
+
+			const T &operator[]( int k ) const { return value[k]; }
+		};
+
+		// Converts each element as it is read.  The elements in memory aren't changed.
+		class const_iterator
+		{
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef Element value_type;
+			typedef ptrdiff_t difference_type;
+			typedef const Element *pointer;
+			typedef Element reference;
+
+			const_iterator() : m_array( NULL ), m_n( 0 ) {}
+			const_iterator( const LazyArray *array, size_t n ) : m_array( array ), m_n( n ) {}
+
+			Element operator*() const
+			{
+				Element e;
+				m_array->get( m_n, e.value );
+				return e;
+			}
+
+			const_iterator &operator++() { ++m_n; return *this; }
+			const_iterator operator++( int ) { const_iterator old( *this ); ++m_n; return old; }
+
+			bool operator==( const const_iterator &other ) const { return m_n == other.m_n && m_array == other.m_array; }
+			bool operator!=( const const_iterator &other ) const { return !(*this == other); }
+
+		private:
+			const LazyArray *m_array;
+			size_t m_n;
+		};
+
+		// count elements of the kind element (ELEMENT_* in changeOfBasisPlan.h) stored in frame.
+		// data isn't copied, so it must outlive the LazyArray.  layout is used by ELEMENT_QUAT
+		// and ELEMENT_MATRIX3X4.  Bad arguments give an invalid, empty array.
+		LazyArray( T *data, size_t count, int element, int layout, FrameId frame );
+
+		// False when an argument was out of range
+		bool isValid() const;
+
+		size_t size() const;
+
+		// The values in one element
+		int getLanes() const;
+
+		// The frame the elements in memory are in
+		FrameId getStoredFrame() const;
+
+		// The frame the elements are read in
+		FrameId getFrame() const;
+
+		// The case number from the stored frame to getFrame().  Reads and materialize() apply it.
+		int getPendingCase() const;
+
+		// Reads the elements in another frame from now on.  Nothing is converted.
+		void retarget( FrameId to );
+
+		// Adds a conversion to the chain, so the elements are read in the frame caseNumber takes
+		// getFrame() to.  caseNumber is an ordinary case number for every element kind, including
+		// ELEMENT_EULER.  Nothing is converted.  Invalid case numbers are ignored.
+		void convert( int caseNumber );
+
+		// Element n converted to getFrame().  out holds getLanes() values.
+		void get( size_t n, T *out ) const
+		{
+			const T *e = m_data + n * m_permutation.lanes;
+			for (int k = 0; k < m_permutation.lanes; ++k)
+			{
+				out[k] = detail::negateIf( e[m_permutation.index[k]], m_permutation.negate[k] ? 1 : 0 );
+			}
+		}
+
+		const_iterator begin() const { return const_iterator( this, 0 ); }
+		const_iterator end() const { return const_iterator( this, m_count ); }
+
+		// Converts the elements in memory to getFrame() with one batch pass, which then becomes
+		// the stored frame.  Does nothing when there is no conversion pending.
+		void materialize();
+
+	private:
+		// Works out m_permutation from the stored frame, m_target and m_case
+		void update();
+
+		T *m_data;
+		size_t m_count;
+		int m_element;
+		int m_layout;
+		FrameId m_frame;
+		FrameId m_target;
+		int m_case;
+		detail::LanePermutation m_permutation;
+		bool m_valid;
+	};
+}
+
+#endif // CHANGEOFBASIS_LAZY_H
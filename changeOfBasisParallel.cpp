@@ -0,0 +1,672 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisParallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+// NUMA placement uses the Linux system calls directly so there is no libnuma dependency.
+// Define COB_NO_NUMA to leave it out.
+#if !defined(COB_NO_NUMA) && defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+	#include <stdio.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#if defined(SYS_move_pages) && defined(SYS_mbind) && defined(SYS_getcpu)
+		#define COB_HAVE_NUMA 1
+	#endif
+#endif
+
+namespace cob
+{
+namespace detail
+{
+
+// Each task converts about this much of the source, which fits in L2 along with its output
+static const size_t CHUNK_BYTES = 256 * 1024;
+
+// Past this many nodes, node n shares the queue and workers of node n % MAX_NODES
+static const int MAX_NODES = 16;
+
+// Kernel node numbers can have gaps, so this many are looked at
+static const int MAX_OS_NODES = 4 * MAX_NODES;
+
+// One parallel batch.  The tasks are grouped by the node that holds their memory and
+// threads claim tasks from their own node's group first by incrementing its next.
+struct Job
+{
+	ParallelTaskFn task;
+	void *context;
+	const size_t *order;				// task numbers by node, or NULL for 0 to taskCount - 1
+	size_t begin[MAX_NODES + 1];		// node n has order[begin[n]] to order[begin[n + 1] - 1]
+	std::atomic<size_t> next[MAX_NODES];
+	int nodes;
+};
+
+// The NUMA nodes, found once.  nodes is 1 when there is no NUMA or it can't be used.
+struct NumaTopology
+{
+	int nodes;
+#ifdef COB_HAVE_NUMA
+	int node[MAX_OS_NODES];				// the node for each kernel node number, or -1
+	cpu_set_t cpus[MAX_NODES];
+#endif
+};
+
+static std::mutex s_runMutex;			// one parallel batch at a time
+static std::mutex s_poolMutex;			// guards everything below
+static std::condition_variable s_wake;
+static std::condition_variable s_idle;
+static std::vector<std::thread> s_workers;
+static Job *s_job = NULL;
+static unsigned long long s_generation = 0;
+static unsigned int s_busy = 0;			// workers still running tasks from s_job
+static bool s_stop = false;
+static unsigned int s_threads = 0;
+static bool s_numa = true;
+static ParallelExecutorFn s_executor = NULL;
+static void *s_executorUser = NULL;
+
+#ifdef COB_HAVE_NUMA
+
+static long pageBytes()
+{
+	const long bytes = sysconf( _SC_PAGESIZE );
+	return (bytes > 0) ? bytes : 4096;
+}
+
+// Parses a sysfs cpu list like "0-15,32-47"
+static bool readCpuList( const char *path, cpu_set_t &cpus )
+{
+	FILE *file = fopen( path, "r" );
+	if (file == NULL) return false;
+
+	CPU_ZERO( &cpus );
+	int first = 0;
+	int last = 0;
+	int found = 0;
+	for (;;)
+	{
+		const int fields = fscanf( file, "%d-%d", &first, &last );
+		if (fields < 1) break;
+		if (fields == 1) last = first;
+		for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+		{
+			CPU_SET( cpu, &cpus );
+			++found;
+		}
+		if (fgetc( file ) != ',') break;
+	}
+	fclose( file );
+	return found > 0;
+}
+
+static int nodeIndex( const NumaTopology &topology, int osNode )
+{
+	return (osNode >= 0 && osNode < MAX_OS_NODES) ? topology.node[osNode] : -1;
+}
+
+static NumaTopology findTopology()
+{
+	NumaTopology topology;
+	topology.nodes = 0;
+
+	int found = 0;
+	for (int osNode = 0; osNode < MAX_OS_NODES; ++osNode)
+	{
+		topology.node[osNode] = -1;
+
+		char path[64];
+		cpu_set_t cpus;
+		snprintf( path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", osNode );
+		if (!readCpuList( path, cpus )) continue;
+
+		// Nodes past MAX_NODES add their cpus to an earlier node
+		const int n = found++ % MAX_NODES;
+		if (n == topology.nodes)
+		{
+			topology.cpus[n] = cpus;
+			++topology.nodes;
+		}
+		else
+		{
+			CPU_OR( &topology.cpus[n], &topology.cpus[n], &cpus );
+		}
+		topology.node[osNode] = n;
+	}
+
+	// Without page placement there is nothing to schedule by
+	if (topology.nodes > 1)
+	{
+		int status = -1;
+		void *page = &status;
+		if (syscall( SYS_move_pages, 0, 1UL, &page, NULL, &status, 0 ) != 0) topology.nodes = 1;
+	}
+
+	if (topology.nodes <= 1)
+	{
+		topology.nodes = 1;
+		for (int osNode = 0; osNode < MAX_OS_NODES; ++osNode)
+		{
+			if (topology.node[osNode] > 0) topology.node[osNode] = 0;
+		}
+	}
+	return topology;
+}
+
+#else
+
+static NumaTopology findTopology()
+{
+	NumaTopology topology;
+	topology.nodes = 1;
+	return topology;
+}
+
+#endif
+
+static const NumaTopology &getTopology()
+{
+	static const NumaTopology topology = findTopology();
+	return topology;
+}
+
+// The node the calling thread is running on
+static int currentNode()
+{
+#ifdef COB_HAVE_NUMA
+	unsigned int cpu = 0;
+	unsigned int osNode = 0;
+	if (syscall( SYS_getcpu, &cpu, &osNode, NULL ) == 0)
+	{
+		const int node = nodeIndex( getTopology(), static_cast<int>(osNode) );
+		if (node >= 0) return node;
+	}
+#endif
+	return 0;
+}
+
+// Caller holds s_poolMutex or s_runMutex
+static int activeNodes()
+{
+	return s_numa ? getTopology().nodes : 1;
+}
+
+// Fills node with the node holding each address, or -1 when it isn't known
+static void findNodes( const void *const *addresses, size_t count, int *node )
+{
+	for (size_t i = 0; i < count; ++i) node[i] = -1;
+
+#ifdef COB_HAVE_NUMA
+	std::vector<void *> pages( count );
+	std::vector<int> status( count, -1 );
+	const uintptr_t mask = ~static_cast<uintptr_t>(pageBytes() - 1);
+	for (size_t i = 0; i < count; ++i)
+	{
+		pages[i] = reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(addresses[i]) & mask);
+	}
+
+	// With no target nodes move_pages only reports where each page is
+	if (count == 0 || syscall( SYS_move_pages, 0, count, &pages[0], NULL, &status[0], 0 ) != 0) return;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (status[i] >= 0) node[i] = nodeIndex( getTopology(), status[i] );
+	}
+#else
+	(void)addresses;
+#endif
+}
+
+static void runTasks( Job &job, int home )
+{
+	for (int n = 0; n < job.nodes; ++n)
+	{
+		const int node = (home + n) % job.nodes;
+		const size_t size = job.begin[node + 1] - job.begin[node];
+		for (;;)
+		{
+			const size_t i = job.next[node].fetch_add( 1 );
+			if (i >= size) break;
+			const size_t t = job.begin[node] + i;
+			job.task( job.context, (job.order != NULL) ? job.order[t] : t );
+		}
+	}
+}
+
+static void workerLoop( int home )
+{
+	std::unique_lock<std::mutex> lock( s_poolMutex );
+	unsigned long long seen = s_generation;
+	for (;;)
+	{
+		s_wake.wait( lock, [&seen]() { return s_stop || s_generation != seen; } );
+		if (s_stop) return;
+
+		seen = s_generation;
+		Job *job = s_job;
+		if (job == NULL) continue;
+
+		++s_busy;
+		lock.unlock();
+		runTasks( *job, home % job->nodes );
+		lock.lock();
+		if (--s_busy == 0) s_idle.notify_all();
+	}
+}
+
+static unsigned int threadCount()
+{
+	if (s_threads != 0) return s_threads;
+	const unsigned int hardware = std::thread::hardware_concurrency();
+	return (hardware != 0) ? hardware : 1;
+}
+
+// Caller holds s_runMutex
+static void stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock( s_poolMutex );
+		s_stop = true;
+	}
+	s_wake.notify_all();
+
+	for (size_t i = 0; i < s_workers.size(); ++i)
+	{
+		s_workers[i].join();
+	}
+	s_workers.clear();
+
+	std::lock_guard<std::mutex> lock( s_poolMutex );
+	s_stop = false;
+}
+
+// Caller holds s_runMutex.  With NUMA the workers are spread over the nodes and each is
+// pinned to the cpus of its node.
+static void startWorkers( unsigned int count )
+{
+	const int nodes = activeNodes();
+	const int callerNode = currentNode() % nodes;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		// The calling thread is the first one on its node
+		const int home = static_cast<int>((callerNode + i + 1) % nodes);
+		s_workers.push_back( std::thread( workerLoop, home ) );
+
+#ifdef COB_HAVE_NUMA
+		if (nodes > 1)
+		{
+			pthread_setaffinity_np( s_workers.back().native_handle(), sizeof(cpu_set_t), &getTopology().cpus[home] );
+		}
+#endif
+	}
+}
+
+// Joins the workers before the statics above are destroyed
+struct PoolShutdown
+{
+	~PoolShutdown()
+	{
+		std::lock_guard<std::mutex> run( s_runMutex );
+		stopWorkers();
+	}
+};
+
+static PoolShutdown s_poolShutdown;
+
+// Fills taskNode with a node from 0 to nodes - 1 for each task
+typedef void (*TaskNodesFn)( void *context, size_t taskCount, int nodes, int *taskNode );
+
+// taskNodes finds the node holding each task's memory, or is NULL to not care.  It is called
+// under s_runMutex, so the node count it is given is the one the job runs with.
+static void runParallel( ParallelTaskFn task, void *context, size_t taskCount, TaskNodesFn taskNodes )
+{
+	std::lock_guard<std::mutex> run( s_runMutex );
+
+	if (s_executor != NULL)
+	{
+		s_executor( s_executorUser, taskCount, task, context );
+		return;
+	}
+
+	const unsigned int threads = threadCount();
+	if (threads <= 1 || taskCount <= 1)
+	{
+		for (size_t t = 0; t < taskCount; ++t) task( context, t );
+		return;
+	}
+
+	if (s_workers.size() + 1 != threads)
+	{
+		stopWorkers();
+		startWorkers( threads - 1 );
+	}
+
+	Job job;
+	job.task = task;
+	job.context = context;
+	job.order = NULL;
+	job.nodes = activeNodes();
+	for (int n = 0; n < MAX_NODES; ++n) job.next[n] = 0;
+
+	// Group the tasks by node, keeping their order within each node
+	std::vector<size_t> order;
+	if (job.nodes > 1 && taskNodes != NULL)
+	{
+		std::vector<int> taskNode( taskCount );
+		taskNodes( context, taskCount, job.nodes, &taskNode[0] );
+
+		order.resize( taskCount );
+		for (int n = 0; n <= job.nodes; ++n) job.begin[n] = 0;
+		for (size_t t = 0; t < taskCount; ++t) ++job.begin[taskNode[t] + 1];
+		for (int n = 0; n < job.nodes; ++n) job.begin[n + 1] += job.begin[n];
+
+		std::vector<size_t> fill( job.begin, job.begin + job.nodes );
+		for (size_t t = 0; t < taskCount; ++t) order[fill[taskNode[t]]++] = t;
+		job.order = &order[0];
+	}
+	else
+	{
+		job.nodes = 1;
+		job.begin[0] = 0;
+		job.begin[1] = taskCount;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( s_poolMutex );
+		s_job = &job;
+		++s_generation;
+	}
+	s_wake.notify_all();
+
+	// The calling thread works too
+	runTasks( job, currentNode() % job.nodes );
+
+	// Every task has been claimed.  Wait for the workers to finish theirs.
+	std::unique_lock<std::mutex> lock( s_poolMutex );
+	s_job = NULL;
+	s_idle.wait( lock, []() { return s_busy == 0; } );
+}
+
+template <typename Kernel, typename T>
+struct PermuteJob
+{
+	Kernel kernel;
+	const LanePermutation *p;
+	const T *src;
+	T *dst;
+	size_t count;
+	size_t chunk;		// elements per task
+	bool stream;
+};
+
+template <typename Kernel, typename T>
+static void permuteChunk( void *context, size_t task )
+{
+	const PermuteJob<Kernel, T> &job = *static_cast<const PermuteJob<Kernel, T> *>(context);
+
+	const size_t L = job.p->lanes;
+	const size_t first = task * job.chunk;
+	const size_t count = (job.count - first < job.chunk) ? job.count - first : job.chunk;
+
+	if (job.stream)
+	{
+		permuteBatchStream( job.kernel, *job.p, job.src + first * L, job.dst + first * L, count );
+	}
+	else
+	{
+		job.kernel( *job.p, job.src + first * L, job.dst + first * L, count );
+	}
+}
+
+// Each chunk goes to a thread on the node holding its source, or else its destination
+template <typename Kernel, typename T>
+static void permuteTaskNodes( void *context, size_t taskCount, int nodes, int *taskNode )
+{
+	const PermuteJob<Kernel, T> &job = *static_cast<const PermuteJob<Kernel, T> *>(context);
+
+	const size_t L = job.p->lanes;
+	std::vector<const void *> addresses( 2 * taskCount );
+	for (size_t t = 0; t < taskCount; ++t)
+	{
+		addresses[t] = job.src + t * job.chunk * L;
+		addresses[taskCount + t] = job.dst + t * job.chunk * L;
+	}
+	std::vector<int> node( 2 * taskCount );
+	findNodes( &addresses[0], 2 * taskCount, &node[0] );
+
+	for (size_t t = 0; t < taskCount; ++t)
+	{
+		const int n = (node[t] >= 0) ? node[t] : node[taskCount + t];
+		taskNode[t] = (n >= 0 && n < nodes) ? n : static_cast<int>(t % nodes);
+	}
+}
+
+template <typename Kernel, typename T>
+static void permuteParallel( Kernel kernel, const LanePermutation &p, const T *src, T *dst, size_t count )
+{
+	const size_t elementBytes = p.lanes * sizeof(T);
+	const size_t bytes = count * elementBytes;
+
+	PermuteJob<Kernel, T> job;
+	job.kernel = kernel;
+	job.p = &p;
+	job.src = src;
+	job.dst = dst;
+	job.count = count;
+	job.stream = (src != dst) && bytes > getLastLevelCacheBytes();
+
+	if (bytes < PARALLEL_MIN_BYTES)
+	{
+		job.chunk = count;
+		permuteChunk<Kernel, T>( &job, 0 );
+		return;
+	}
+
+	// A multiple of 64 elements so no two tasks write to the same cache line
+	job.chunk = (CHUNK_BYTES / elementBytes) & ~static_cast<size_t>(63);
+	if (job.chunk == 0) job.chunk = 64;
+
+	const size_t taskCount = (count + job.chunk - 1) / job.chunk;
+	runParallel( permuteChunk<Kernel, T>, &job, taskCount, permuteTaskNodes<Kernel, T> );
+}
+
+void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	permuteParallel( k.permuteDouble, p, src, dst, count );
+}
+
+void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	permuteParallel( k.permuteFloat, p, src, dst, count );
+}
+
+void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	permuteParallel( k.permuteHalf, p, src, dst, count );
+}
+
+void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count )
+{
+	permuteParallel( k.permuteInt16, p, src, dst, count );
+}
+
+void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	permuteParallel( k.permuteInt32, p, src, dst, count );
+}
+
+} // namespace detail
+
+void setParallelThreads( unsigned int threads )
+{
+	std::lock_guard<std::mutex> run( detail::s_runMutex );
+	detail::stopWorkers();
+	detail::s_threads = threads;
+}
+
+unsigned int getParallelThreads()
+{
+	std::lock_guard<std::mutex> run( detail::s_runMutex );
+	return detail::threadCount();
+}
+
+void setParallelNuma( bool enable )
+{
+	std::lock_guard<std::mutex> run( detail::s_runMutex );
+	detail::stopWorkers();
+	std::lock_guard<std::mutex> lock( detail::s_poolMutex );
+	detail::s_numa = enable;
+}
+
+int getParallelNumaNodes()
+{
+	std::lock_guard<std::mutex> lock( detail::s_poolMutex );
+	return detail::activeNodes();
+}
+
+void *allocateOnNode( size_t bytes, int node )
+{
+#ifdef COB_HAVE_NUMA
+	if (bytes == 0) bytes = 1;
+	void *memory = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if (memory == MAP_FAILED) return NULL;
+
+	const detail::NumaTopology &topology = detail::getTopology();
+	if (topology.nodes > 1 && node < topology.nodes)
+	{
+		// mbind takes a bit mask of the kernel's node numbers
+		const int MPOL_BIND_MODE = 2;
+		const int MPOL_INTERLEAVE_MODE = 3;
+		const int MASK_BITS = 8 * sizeof(unsigned long);
+
+		unsigned long mask[detail::MAX_OS_NODES / MASK_BITS + 1] = { 0 };
+		for (int osNode = 0; osNode < detail::MAX_OS_NODES; ++osNode)
+		{
+			const int n = topology.node[osNode];
+			if (n >= 0 && (node == NUMA_INTERLEAVE || node == n))
+			{
+				mask[osNode / MASK_BITS] |= 1UL << (osNode % MASK_BITS);
+			}
+		}
+
+		// Only a hint: if it fails the pages go wherever they are first touched
+		syscall( SYS_mbind, memory, bytes, (node == NUMA_INTERLEAVE) ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE,
+			mask, static_cast<unsigned long>(sizeof(mask) * 8), 0U );
+	}
+	return memory;
+#else
+	(void)node;
+	return malloc( bytes );
+#endif
+}
+
+void freeOnNode( void *memory, size_t bytes )
+{
+	if (memory == NULL) return;
+#ifdef COB_HAVE_NUMA
+	munmap( memory, (bytes != 0) ? bytes : 1 );
+#else
+	(void)bytes;
+	free( memory );
+#endif
+}
+
+void setParallelExecutor( ParallelExecutorFn executor, void *user )
+{
+	std::lock_guard<std::mutex> run( detail::s_runMutex );
+	detail::s_executor = executor;
+	detail::s_executorUser = user;
+}
+
+void vectorCobBatchParallel( int caseNumber, double *v, size_t count )
+{
+	vectorCobBatchParallel( caseNumber, v, v, count );
+}
+
+void vectorCobBatchParallel( int caseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatchParallel( detail::getActiveKernels(), p, src, dst, count );
+}
+
+void vectorCobBatchParallel( int caseNumber, float *v, size_t count )
+{
+	vectorCobBatchParallel( caseNumber, v, v, count );
+}
+
+void vectorCobBatchParallel( int caseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getVectorPermutation( caseNumber, p );
+	detail::permuteBatchParallel( detail::getActiveKernels(), p, src, dst, count );
+}
+
+void quatCobBatchParallel( int caseNumber, int layout, double *q, size_t count )
+{
+	quatCobBatchParallel( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatchParallel( int caseNumber, int layout, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatchParallel( detail::getActiveKernels(), p, src, dst, count );
+}
+
+void quatCobBatchParallel( int caseNumber, int layout, float *q, size_t count )
+{
+	quatCobBatchParallel( caseNumber, layout, q, q, count );
+}
+
+void quatCobBatchParallel( int caseNumber, int layout, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getQuatPermutation( caseNumber, layout, p );
+	detail::permuteBatchParallel( detail::getActiveKernels(), p, src, dst, count );
+}
+
+void matrixCob3x3BatchParallel( int caseNumber, double *m, size_t count )
+{
+	matrixCob3x3BatchParallel( caseNumber, m, m, count );
+}
+
+void matrixCob3x3BatchParallel( int caseNumber, const double *src, double *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatchParallel( detail::getActiveKernels(), p, src, dst, count );
+}
+
+void matrixCob3x3BatchParallel( int caseNumber, float *m, size_t count )
+{
+	matrixCob3x3BatchParallel( caseNumber, m, m, count );
+}
+
+void matrixCob3x3BatchParallel( int caseNumber, const float *src, float *dst, size_t count )
+{
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( caseNumber, p );
+	detail::permuteBatchParallel( detail::getActiveKernels(), p, src, dst, count );
+}
+
+} // namespace cob
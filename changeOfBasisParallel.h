@@ -0,0 +1,99 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef CHANGEOFBASIS_PARALLEL_H
+#define	CHANGEOFBASIS_PARALLEL_H
+
+#include "changeOfBasis.h"
+#include "changeOfBasisKernels.h"
+
+// Parallel batch change of basis for very large buffers (ex. point clouds).
+// The buffer is split into chunks about the size of L2 and the chunks are converted by a
+// pool of threads, or by your own executor.  When the output is a different buffer larger
+// than the last level cache it is written with non-temporal stores, so the conversion
+// doesn't read the output in first or push everything else out of the caches.
+// Buffers too small to be worth it are converted on the calling thread.
+//
+// On Linux machines with more than one NUMA node the pool's threads are spread over the
+// nodes and pinned to them, and each chunk is converted by a thread on the node that holds
+// its memory.  allocateOnNode() places big buffers on purpose.
+//
+// Only one parallel batch runs at a time.  Calls from several threads take turns.
+
+namespace cob
+{
+	// The number of threads the internal pool uses, including the calling thread.  0 means one
+	// per hardware thread, which is the default.  Don't call this while a parallel batch is running.
+	void setParallelThreads( unsigned int threads );
+	unsigned int getParallelThreads();
+
+	// Turns the NUMA scheduling on or off.  It is on by default.  Don't call this while a parallel
+	// batch is running.
+	void setParallelNuma( bool enable );
+
+	// The number of NUMA nodes the pool schedules for.  1 when NUMA is off, isn't there or can't
+	// be used (ex. not Linux, or the system calls are blocked).
+	int getParallelNumaNodes();
+
+	// Allocates bytes of memory from one NUMA node, numbered 0 to getParallelNumaNodes() - 1, or
+	// spread a page at a time over every node with NUMA_INTERLEAVE.  Interleaving the output of
+	// a big conversion lets every node write at full speed.  Without NUMA this is malloc().
+	// Returns NULL when out of memory.  Free it with freeOnNode() and the same size.
+	const int NUMA_INTERLEAVE = -1;
+	void *allocateOnNode( size_t bytes, int node );
+	void freeOnNode( void *memory, size_t bytes );
+
+	// Runs task( context, i ) for every i from 0 to taskCount - 1, in any order and on any
+	// threads, and returns when all of them have finished.
+	typedef void (*ParallelTaskFn)( void *context, size_t task );
+	typedef void (*ParallelExecutorFn)( void *user, size_t taskCount, ParallelTaskFn task, void *context );
+
+	// Runs the parallel batches on your own threads instead of the internal pool, which also
+	// leaves the NUMA scheduling to you.  Pass NULL to go back to the pool.  Don't call this while a parallel batch is running.
+	void setParallelExecutor( ParallelExecutorFn executor, void *user );
+
+	// Same as the batch functions in changeOfBasis.h.  src and dst may be the same array.
+	void vectorCobBatchParallel( int caseNumber, double *v, size_t count );
+	void vectorCobBatchParallel( int caseNumber, const double *src, double *dst, size_t count );
+	void vectorCobBatchParallel( int caseNumber, float *v, size_t count );
+	void vectorCobBatchParallel( int caseNumber, const float *src, float *dst, size_t count );
+
+	void quatCobBatchParallel( int caseNumber, int layout, double *q, size_t count );
+	void quatCobBatchParallel( int caseNumber, int layout, const double *src, double *dst, size_t count );
+	void quatCobBatchParallel( int caseNumber, int layout, float *q, size_t count );
+	void quatCobBatchParallel( int caseNumber, int layout, const float *src, float *dst, size_t count );
+
+	void matrixCob3x3BatchParallel( int caseNumber, double *m, size_t count );
+	void matrixCob3x3BatchParallel( int caseNumber, const double *src, double *dst, size_t count );
+	void matrixCob3x3BatchParallel( int caseNumber, float *m, size_t count );
+	void matrixCob3x3BatchParallel( int caseNumber, const float *src, float *dst, size_t count );
+
+	namespace detail
+	{
+		// Below this many bytes waking the threads costs more than it saves, so
+		// permuteBatchParallel() converts on the calling thread
+		const size_t PARALLEL_MIN_BYTES = 1024 * 1024;
+
+		// Splits count elements into chunks and runs the kernel from k on them in parallel
+		void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const double *src, double *dst, size_t count );
+		void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const float *src, float *dst, size_t count );
+		void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count );
+		void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count );
+		void permuteBatchParallel( const PermuteKernels &k, const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count );
+	}
+}
+
+#endif // CHANGEOFBASIS_PARALLEL_H
@@ -0,0 +1,479 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisPlan.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cob
+{
+namespace detail
+{
+
+// Each kernel is timed on at most this much data so planning stays quick.  Larger
+// expected counts are timed at this size, which is already well past the caches.
+static const size_t MAX_TRIAL_BYTES = 16 * 1024 * 1024;
+static const int TRIAL_REPEATS = 3;
+
+static const char WISDOM_HEADER[] = "cob-wisdom 3";
+
+// Files from before the threading mode was part of the key.  Their lines are all threads.
+static const char WISDOM_HEADER_2[] = "cob-wisdom 2";
+
+static const size_t scalarBytes[SCALAR_COUNT] = { 8, 4, 2, 2, 4 };
+
+struct Wisdom
+{
+	int scalar;
+	int lanes;
+	int sizeBucket;		// log2 of the bytes in the expected count
+	int oneThread;		// 1 when measured for a PLAN_ONE_THREAD plan
+	int simdLevel;
+	int parallel;		// 1 to use permuteBatchParallel()
+};
+
+static std::vector<Wisdom> s_wisdom;
+static std::mutex s_wisdomMutex;
+
+static int sizeBucket( size_t bytes )
+{
+	int bucket = 0;
+	while (bytes > 1)
+	{
+		bytes >>= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+static bool findWisdom( int scalar, int lanes, int bucket, bool oneThread, int &simdLevel, bool &parallel )
+{
+	std::lock_guard<std::mutex> lock( s_wisdomMutex );
+	const Wisdom *serial = NULL;
+	for (size_t i = 0; i < s_wisdom.size(); ++i)
+	{
+		const Wisdom &w = s_wisdom[i];
+		if (w.scalar != scalar || w.lanes != lanes || w.sizeBucket != bucket) continue;
+
+		if (w.oneThread == (oneThread ? 1 : 0))
+		{
+			simdLevel = w.simdLevel;
+			parallel = w.parallel != 0;
+			return true;
+		}
+
+		// An all threads answer that stayed on one thread also suits a one thread plan.  The
+		// parallel winner says nothing about the best kernel on one thread.
+		if (oneThread && !w.parallel) serial = &w;
+	}
+
+	if (serial == NULL) return false;
+	simdLevel = serial->simdLevel;
+	parallel = false;
+	return true;
+}
+
+// Caller holds s_wisdomMutex
+static void addWisdomLocked( const Wisdom &wisdom )
+{
+	for (size_t i = 0; i < s_wisdom.size(); ++i)
+	{
+		Wisdom &w = s_wisdom[i];
+		if (w.scalar == wisdom.scalar && w.lanes == wisdom.lanes && w.sizeBucket == wisdom.sizeBucket &&
+			w.oneThread == wisdom.oneThread)
+		{
+			w.simdLevel = wisdom.simdLevel;
+			w.parallel = wisdom.parallel;
+			return;
+		}
+	}
+	s_wisdom.push_back( wisdom );
+}
+
+static void addWisdom( const Wisdom &wisdom )
+{
+	std::lock_guard<std::mutex> lock( s_wisdomMutex );
+	addWisdomLocked( wisdom );
+}
+
+static PermuteDoubleFn kernelFor( const PermuteKernels &k, const double * ) { return k.permuteDouble; }
+static PermuteFloatFn kernelFor( const PermuteKernels &k, const float * ) { return k.permuteFloat; }
+static PermuteHalfFn kernelFor( const PermuteKernels &k, const uint16_t * ) { return k.permuteHalf; }
+static PermuteInt16Fn kernelFor( const PermuteKernels &k, const int16_t * ) { return k.permuteInt16; }
+static PermuteInt32Fn kernelFor( const PermuteKernels &k, const int32_t * ) { return k.permuteInt32; }
+
+template <typename T>
+static double timeTrial( const PermuteKernels &k, bool parallel, const LanePermutation &p, std::vector<T> &src, std::vector<T> &dst, size_t count )
+{
+	const auto kernel = kernelFor( k, &src[0] );
+
+	double best = 0.0;
+	for (int r = 0; r < TRIAL_REPEATS; ++r)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		if (parallel)
+		{
+			permuteBatchParallel( k, p, &src[0], &dst[0], count );
+			permuteBatchParallel( k, p, &dst[0], &dst[0], count );
+		}
+		else
+		{
+			kernel( p, &src[0], &dst[0], count );
+			kernel( p, &dst[0], &dst[0], count );
+		}
+		const double t = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+		if (r == 0 || t < best) best = t;
+	}
+	return best;
+}
+
+// Times every SIMD level the CPU has on count elements, out of place and then in place
+// since execute() is used both ways.  Then times the fastest one on all threads, unless
+// the trial is too small for permuteBatchParallel() to use them.
+template <typename T>
+static int measureBest( const LanePermutation &p, size_t count, bool oneThread, bool &parallel )
+{
+	const size_t maxCount = MAX_TRIAL_BYTES / (p.lanes * sizeof(T));
+	if (count > maxCount) count = maxCount;
+	if (count < 1) count = 1;
+
+	std::vector<T> src( count * p.lanes );
+	std::vector<T> dst( count * p.lanes );
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = static_cast<T>(i % 61);
+	}
+
+	int best = SIMD_NONE;
+	double bestNs = 0.0;
+	for (int level = SIMD_NONE; level <= getMaxSimdLevel(); ++level)
+	{
+		PermuteKernels k;
+		if (getPermuteKernels( level, k ) != level) continue;
+
+		// Warm up the caches and the page mappings
+		kernelFor( k, &src[0] )( p, &src[0], &dst[0], count );
+
+		const double ns = timeTrial( k, false, p, src, dst, count );
+		if (level == SIMD_NONE || ns < bestNs)
+		{
+			best = level;
+			bestNs = ns;
+		}
+	}
+
+	parallel = false;
+	if (!oneThread && count * p.lanes * sizeof(T) >= PARALLEL_MIN_BYTES)
+	{
+		PermuteKernels k;
+		getPermuteKernels( best, k );
+		parallel = timeTrial( k, true, p, src, dst, count ) < bestNs;
+	}
+	return best;
+}
+
+static int measureBest( int scalar, const LanePermutation &p, size_t count, bool oneThread, bool &parallel )
+{
+	switch (scalar)
+	{
+		case SCALAR_DOUBLE: return measureBest<double>( p, count, oneThread, parallel );
+		case SCALAR_FLOAT: return measureBest<float>( p, count, oneThread, parallel );
+		case SCALAR_HALF: return measureBest<uint16_t>( p, count, oneThread, parallel );
+		case SCALAR_INT16: return measureBest<int16_t>( p, count, oneThread, parallel );
+		default: return measureBest<int32_t>( p, count, oneThread, parallel );
+	}
+}
+
+bool getElementPermutation( int element, int caseNumber, int layout, LanePermutation &p )
+{
+	switch (element)
+	{
+		case ELEMENT_VECTOR:
+			getVectorPermutation( caseNumber, p );
+			return true;
+		case ELEMENT_PSEUDOVECTOR:
+			getPseudoVectorPermutation( caseNumber, p );
+			return true;
+		case ELEMENT_QUAT:
+			if (layout != QUAT_XYZW && layout != QUAT_WXYZ) return false;
+			getQuatPermutation( caseNumber, layout, p );
+			return true;
+		case ELEMENT_MATRIX3X3:
+			getMatrixPermutation( caseNumber, p );
+			return true;
+		case ELEMENT_MATRIX4X4:
+			getMatrix4x4Permutation( caseNumber, p );
+			return true;
+		case ELEMENT_MATRIX3X4:
+			if (layout != MATRIX_ROW_MAJOR && layout != MATRIX_COLUMN_MAJOR) return false;
+			getMatrix3x4Permutation( caseNumber, layout, p );
+			return true;
+		case ELEMENT_EULER:
+			getEulerPermutation( caseNumber, p );
+			return true;
+	}
+	return false;
+}
+
+template <typename T>
+static bool copyElements( int element, int layout, int caseNumber, const T *src, T *dst, size_t count, int flags )
+{
+	LanePermutation p;
+	if (!getElementPermutation( element, caseNumber, layout, p )) return false;
+
+	const auto kernel = kernelFor( getActiveKernels(), src );
+	const bool big = src != dst && count * p.lanes * sizeof(T) > getLastLevelCacheBytes();
+	if (src != dst && (flags & COPY_DEVICE_SOURCE))
+	{
+		permuteStreamLoad( kernel, p, src, dst, count, big );
+	}
+	else if (big)
+	{
+		permuteBatchStream( kernel, p, src, dst, count );
+	}
+	else
+	{
+		kernel( p, src, dst, count );
+	}
+	return true;
+}
+
+} // namespace detail
+
+Plan::Plan()
+	: m_scalar( SCALAR_DOUBLE ), m_caseNumber( 0 ), m_simdLevel( SIMD_NONE ), m_parallel( false ), m_valid( false )
+{
+	m_permutation.lanes = 0;
+	detail::getPermuteKernels( SIMD_NONE, m_kernels );
+}
+
+Plan::Plan( const triple &from, const triple &to, int element, int scalar, int layout,
+	size_t stride, size_t expectedCount, int flags )
+	: m_scalar( scalar ), m_caseNumber( 0 ), m_simdLevel( SIMD_NONE ), m_parallel( false ), m_valid( false )
+{
+	m_permutation.lanes = 0;
+	detail::getPermuteKernels( SIMD_NONE, m_kernels );
+
+	if (scalar < 0 || scalar >= SCALAR_COUNT) return;
+
+	m_caseNumber = (element == ELEMENT_EULER) ? cob::getEulerCaseNumber( from, to ) : cob::getCaseNumber( from, to );
+
+	detail::LanePermutation e;
+	if (!detail::getElementPermutation( element, m_caseNumber, layout, e )) return;
+
+	// Pad the element out to the stride with values that are copied unchanged
+	const size_t lanes = (stride == 0) ? static_cast<size_t>(e.lanes) : stride;
+	if (lanes < static_cast<size_t>(e.lanes) || lanes > static_cast<size_t>(PLAN_MAX_STRIDE)) return;
+
+	m_permutation.lanes = static_cast<int>(lanes);
+	for (int k = 0; k < m_permutation.lanes; ++k)
+	{
+		const bool inElement = k < e.lanes;
+		m_permutation.index[k] = inElement ? e.index[k] : k;
+		m_permutation.negate[k] = inElement && e.negate[k];
+	}
+
+	const int bucket = detail::sizeBucket( expectedCount * lanes * detail::scalarBytes[scalar] );
+
+	const bool oneThread = (flags & PLAN_ONE_THREAD) != 0;
+
+	int level = detail::getMaxSimdLevel();
+	if (!detail::findWisdom( scalar, m_permutation.lanes, bucket, oneThread, level, m_parallel ) && (flags & PLAN_MEASURE))
+	{
+		level = detail::measureBest( scalar, m_permutation, expectedCount, oneThread, m_parallel );
+
+		const detail::Wisdom wisdom = { scalar, m_permutation.lanes, bucket, oneThread ? 1 : 0, level, m_parallel ? 1 : 0 };
+		detail::addWisdom( wisdom );
+	}
+
+	m_simdLevel = detail::getPermuteKernels( level, m_kernels );
+	m_valid = true;
+}
+
+bool Plan::isValid() const
+{
+	return m_valid;
+}
+
+int Plan::getCaseNumber() const
+{
+	return m_caseNumber;
+}
+
+int Plan::getSimdLevel() const
+{
+	return m_simdLevel;
+}
+
+bool Plan::isParallel() const
+{
+	return m_parallel;
+}
+
+bool Plan::execute( const double *src, double *dst, size_t count ) const
+{
+	if (!m_valid || m_scalar != SCALAR_DOUBLE) return false;
+	if (m_parallel)
+	{
+		detail::permuteBatchParallel( m_kernels, m_permutation, src, dst, count );
+	}
+	else
+	{
+		m_kernels.permuteDouble( m_permutation, src, dst, count );
+	}
+	return true;
+}
+
+bool Plan::execute( const float *src, float *dst, size_t count ) const
+{
+	if (!m_valid || m_scalar != SCALAR_FLOAT) return false;
+	if (m_parallel)
+	{
+		detail::permuteBatchParallel( m_kernels, m_permutation, src, dst, count );
+	}
+	else
+	{
+		m_kernels.permuteFloat( m_permutation, src, dst, count );
+	}
+	return true;
+}
+
+bool Plan::execute( const uint16_t *src, uint16_t *dst, size_t count ) const
+{
+	if (!m_valid || m_scalar != SCALAR_HALF) return false;
+	if (m_parallel)
+	{
+		detail::permuteBatchParallel( m_kernels, m_permutation, src, dst, count );
+	}
+	else
+	{
+		m_kernels.permuteHalf( m_permutation, src, dst, count );
+	}
+	return true;
+}
+
+bool Plan::execute( const int16_t *src, int16_t *dst, size_t count ) const
+{
+	if (!m_valid || m_scalar != SCALAR_INT16) return false;
+	if (m_parallel)
+	{
+		detail::permuteBatchParallel( m_kernels, m_permutation, src, dst, count );
+	}
+	else
+	{
+		m_kernels.permuteInt16( m_permutation, src, dst, count );
+	}
+	return true;
+}
+
+bool Plan::execute( const int32_t *src, int32_t *dst, size_t count ) const
+{
+	if (!m_valid || m_scalar != SCALAR_INT32) return false;
+	if (m_parallel)
+	{
+		detail::permuteBatchParallel( m_kernels, m_permutation, src, dst, count );
+	}
+	else
+	{
+		m_kernels.permuteInt32( m_permutation, src, dst, count );
+	}
+	return true;
+}
+
+bool cobCopy( int element, int layout, int caseNumber, const double *src, double *dst, size_t count, int flags )
+{
+	return detail::copyElements( element, layout, caseNumber, src, dst, count, flags );
+}
+
+bool cobCopy( int element, int layout, int caseNumber, const float *src, float *dst, size_t count, int flags )
+{
+	return detail::copyElements( element, layout, caseNumber, src, dst, count, flags );
+}
+
+bool cobCopy( int element, int layout, int caseNumber, const uint16_t *src, uint16_t *dst, size_t count, int flags )
+{
+	return detail::copyElements( element, layout, caseNumber, src, dst, count, flags );
+}
+
+bool cobCopy( int element, int layout, int caseNumber, const int16_t *src, int16_t *dst, size_t count, int flags )
+{
+	return detail::copyElements( element, layout, caseNumber, src, dst, count, flags );
+}
+
+bool cobCopy( int element, int layout, int caseNumber, const int32_t *src, int32_t *dst, size_t count, int flags )
+{
+	return detail::copyElements( element, layout, caseNumber, src, dst, count, flags );
+}
+
+// The file is a header line and then one line per choice:
+//   scalar lanes sizeBucket oneThread simdLevel parallel
+// Version 2 files have no oneThread.
+bool importWisdom( const char *path )
+{
+	std::ifstream file( path );
+	std::string header;
+	if (!file || !std::getline( file, header )) return false;
+	const bool version2 = header == detail::WISDOM_HEADER_2;
+	if (!version2 && header != detail::WISDOM_HEADER) return false;
+
+	std::vector<detail::Wisdom> read;
+	detail::Wisdom w;
+	w.oneThread = 0;
+	while (file >> w.scalar >> w.lanes >> w.sizeBucket && (version2 || file >> w.oneThread) && file >> w.simdLevel >> w.parallel)
+	{
+		if (w.scalar < 0 || w.scalar >= SCALAR_COUNT) return false;
+		if (w.lanes < 1 || w.lanes > PLAN_MAX_STRIDE) return false;
+		if (w.sizeBucket < 0 || w.sizeBucket > 63) return false;
+		if (w.oneThread != 0 && w.oneThread != 1) return false;
+		if (w.simdLevel < SIMD_NONE || w.simdLevel > SIMD_AVX512) return false;
+		if (w.parallel != 0 && w.parallel != 1) return false;
+		if (w.oneThread && w.parallel) return false;
+		read.push_back( w );
+	}
+	if (!file.eof()) return false;
+
+	std::lock_guard<std::mutex> lock( detail::s_wisdomMutex );
+	for (size_t i = 0; i < read.size(); ++i)
+	{
+		detail::addWisdomLocked( read[i] );
+	}
+	return true;
+}
+
+bool exportWisdom( const char *path )
+{
+	std::ofstream file( path );
+	if (!file) return false;
+
+	std::lock_guard<std::mutex> lock( detail::s_wisdomMutex );
+	file << detail::WISDOM_HEADER << "\n";
+	for (size_t i = 0; i < detail::s_wisdom.size(); ++i)
+	{
+		const detail::Wisdom &w = detail::s_wisdom[i];
+		file << w.scalar << " " << w.lanes << " " << w.sizeBucket << " " << w.oneThread << " " << w.simdLevel << " " << w.parallel << "\n";
+	}
+	return static_cast<bool>(file);
+}
+
+void forgetWisdom()
+{
+	std::lock_guard<std::mutex> lock( detail::s_wisdomMutex );
+	detail::s_wisdom.clear();
+}
+
+} // namespace cob
@@ -0,0 +1,142 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef CHANGEOFBASIS_PLAN_H
+#define	CHANGEOFBASIS_PLAN_H
+
+#include "changeOfBasis.h"
+#include "changeOfBasisKernels.h"
+#include "changeOfBasisParallel.h"
+
+// Plans for large conversions that are done over and over.
+// A Plan does all of the setup once: it works out the case number, builds the shuffle
+// and sign mask for one element and picks the fastest kernel for the data by timing each
+// one on a buffer the size of the expected count, on one thread and then on all of them
+// (see changeOfBasisParallel.h).  execute() is then only the kernel.
+// The choices can be saved to a wisdom file so later runs skip the timing.
+//
+// example:
+//   cob::Plan plan( SensorVendorFrame, cob::Unreal3Frame, cob::ELEMENT_QUAT, cob::SCALAR_FLOAT,
+//       cob::QUAT_XYZW, 0, 100000 );
+//   plan.execute( src, dst, count );
+
+namespace cob
+{
+	// What a plan converts.  layout is only used by some of them.
+	const int ELEMENT_VECTOR = 0;
+	const int ELEMENT_PSEUDOVECTOR = 1;
+	const int ELEMENT_QUAT = 2;			// layout is QUAT_XYZW or QUAT_WXYZ
+	const int ELEMENT_MATRIX3X3 = 3;
+	const int ELEMENT_MATRIX4X4 = 4;
+	const int ELEMENT_MATRIX3X4 = 5;	// layout is MATRIX_ROW_MAJOR or MATRIX_COLUMN_MAJOR
+	const int ELEMENT_EULER = 6;		// yaw, pitch, roll
+	const int ELEMENT_COUNT = 7;
+
+	// The type of each value
+	const int SCALAR_DOUBLE = 0;
+	const int SCALAR_FLOAT = 1;
+	const int SCALAR_HALF = 2;			// IEEE half float stored as uint16_t
+	const int SCALAR_INT16 = 3;
+	const int SCALAR_INT32 = 4;
+	const int SCALAR_COUNT = 5;
+
+	// How much work a plan does to pick a kernel
+	const int PLAN_ESTIMATE = 0;		// use the wisdom, or else the best SIMD level the CPU has
+	const int PLAN_MEASURE = 1;			// use the wisdom, or else time each kernel and remember the winner
+
+	// Added to either of the above so the plan only ever uses the calling thread
+	const int PLAN_ONE_THREAD = 2;
+
+	// The most values from one element to the next
+	const int PLAN_MAX_STRIDE = detail::MAX_LANES;
+
+	class Plan
+	{
+	public:
+		// An invalid plan that does nothing
+		Plan();
+
+		// stride is the number of values from one element to the next, or 0 when they are
+		// packed.  Values past the end of an element are copied unchanged.  expectedCount is
+		// the number of elements a typical execute() will convert.
+		Plan( const triple &from, const triple &to, int element, int scalar, int layout,
+			size_t stride, size_t expectedCount, int flags = PLAN_MEASURE );
+
+		// False when an argument is out of range.  An invalid plan does nothing.
+		bool isValid() const;
+
+		// The case number, or the Euler case number for ELEMENT_EULER
+		int getCaseNumber() const;
+
+		// The SIMD level of the kernel the plan picked
+		int getSimdLevel() const;
+
+		// True when the plan picked the parallel version of the kernel
+		bool isParallel() const;
+
+		// Converts count elements.  src and dst may be the same array.  Returns false and does
+		// nothing when the plan is invalid or was made for a different scalar type.
+		bool execute( const double *src, double *dst, size_t count ) const;
+		bool execute( const float *src, float *dst, size_t count ) const;
+		bool execute( const uint16_t *src, uint16_t *dst, size_t count ) const;
+		bool execute( const int16_t *src, int16_t *dst, size_t count ) const;
+		bool execute( const int32_t *src, int32_t *dst, size_t count ) const;
+
+	private:
+		detail::LanePermutation m_permutation;
+		detail::PermuteKernels m_kernels;
+		int m_scalar;
+		int m_caseNumber;
+		int m_simdLevel;
+		bool m_parallel;
+		bool m_valid;
+	};
+
+	// Copies count elements from src to dst and converts them on the way, for data that arrives
+	// in a network or DMA buffer and has to be copied into your own memory anyway.  This reads
+	// and writes the data once instead of a memcpy() and then a batch conversion in place.
+	// Copies bigger than the last level cache are written with non-temporal stores, so the
+	// output isn't read in first and doesn't evict your caches.  element, layout and caseNumber
+	// are as for a Plan, with an Euler case number for ELEMENT_EULER.  src and dst must not
+	// overlap unless they are the same array.  Returns false and does nothing when element or
+	// layout is out of range.
+	const int COPY_DEFAULT = 0;
+	const int COPY_DEVICE_SOURCE = 1;	// src is write-combining memory a device writes (ex. a mapped PCIe BAR), so read it with streaming loads (AVX2 CPUs only)
+
+	bool cobCopy( int element, int layout, int caseNumber, const double *src, double *dst, size_t count, int flags = COPY_DEFAULT );
+	bool cobCopy( int element, int layout, int caseNumber, const float *src, float *dst, size_t count, int flags = COPY_DEFAULT );
+	bool cobCopy( int element, int layout, int caseNumber, const uint16_t *src, uint16_t *dst, size_t count, int flags = COPY_DEFAULT );
+	bool cobCopy( int element, int layout, int caseNumber, const int16_t *src, int16_t *dst, size_t count, int flags = COPY_DEFAULT );
+	bool cobCopy( int element, int layout, int caseNumber, const int32_t *src, int32_t *dst, size_t count, int flags = COPY_DEFAULT );
+
+	// Wisdom is the kernel and threading each measured plan picked, for each scalar type,
+	// element size, data size and whether the plan was made with PLAN_ONE_THREAD.  Plans made afterwards with the same shape use it without timing anything.
+	// Returns false when the file can't be read or written or isn't a wisdom file.
+	bool importWisdom( const char *path );
+	bool exportWisdom( const char *path );
+
+	// Forgets all wisdom so the next plans are measured again
+	void forgetWisdom();
+
+	namespace detail
+	{
+		// The shuffle and sign mask for one element, with an Euler case number for ELEMENT_EULER.
+		// Returns false for a bad element or layout.
+		bool getElementPermutation( int element, int caseNumber, int layout, LanePermutation &p );
+	}
+}
+
+#endif // CHANGEOFBASIS_PLAN_H
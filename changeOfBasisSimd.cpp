@@ -0,0 +1,1499 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisKernels.h"
+
+#include <string.h>
+
+#if defined(COB_HAVE_AVX2) || defined(COB_HAVE_AVX512)
+#include <immintrin.h>
+#endif
+#ifdef COB_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// SIMD versions of the signed lane permutation.  A change of basis on an element is
+// one lane permute followed by one XOR with a mask of sign bits.  The permute controls
+// and sign masks are built once per batch from the LanePermutation.  When an element
+// has more lanes than a register, a gather (AVX2) or two-source permute (AVX-512) is
+// used instead.  Any elements left over at the end go through the scalar kernel.
+
+namespace cob
+{
+namespace detail
+{
+
+static const unsigned long long SIGN_BIT_64 = 0x8000000000000000ULL;
+static const unsigned int SIGN_BIT_32 = 0x80000000U;
+static const unsigned short SIGN_BIT_16 = 0x8000U;
+
+#if defined(COB_HAVE_AVX2) || defined(COB_HAVE_AVX512)
+
+// True when elements of lanes values fill whole registers of width lanes with none left over
+static inline bool fillsRegisters( int lanes, int width )
+{
+	return (lanes <= width) ? (width % lanes == 0) : (lanes % width == 0);
+}
+
+// In place, each store of an element that doesn't fill whole registers overlaps the start of
+// the next load, which then waits for the store to reach L1 instead of being forwarded.  That
+// makes those kernels several times slower in place, so in place batches are copied a block
+// at a time into a buffer in L1 and converted from there back into the array.
+static const size_t BOUNCE_BYTES = 4096;
+
+template <typename T>
+static void permuteBounced( void (*kernel)( const LanePermutation &, const T *, T *, size_t ), const LanePermutation &p, T *v, size_t count )
+{
+	T buffer[BOUNCE_BYTES / sizeof(T)];
+	const size_t block = (BOUNCE_BYTES / sizeof(T)) / p.lanes;
+
+	for (size_t n = 0; n < count; n += block)
+	{
+		const size_t b = (count - n < block) ? count - n : block;
+		T *d = v + n * p.lanes;
+		memcpy( buffer, d, b * p.lanes * sizeof(T) );
+		kernel( p, buffer, d, b );
+	}
+}
+
+#endif
+
+#ifdef COB_HAVE_AVX2
+
+// Elements of up to 4 doubles.  Doubles are permuted as pairs of 32 bit lanes since
+// AVX2 has no variable cross lane permute for doubles.
+COB_TARGET("avx2")
+static void permuteShuffleAvx2( const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int per = 4 / L;		// elements per register
+	const int used = per * L;	// lanes per register that hold elements
+
+	int ctrl[8];
+	unsigned long long sign[4];
+	long long mask[4];
+	for (int k = 0; k < 4; ++k)
+	{
+		int from = k;
+		bool negate = false;
+		if (k < used)
+		{
+			from = (k / L) * L + p.index[k % L];
+			negate = p.negate[k % L];
+		}
+		ctrl[2 * k] = 2 * from;
+		ctrl[2 * k + 1] = 2 * from + 1;
+		sign[k] = negate ? SIGN_BIT_64 : 0;
+		mask[k] = (k < used) ? -1 : 0;
+	}
+
+	const __m256i vctrl = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(ctrl) );
+	const __m256d vsign = _mm256_castsi256_pd( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(sign) ) );
+	const __m256i vmask = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+
+	size_t n = 0;
+	if (used == 4)
+	{
+		for (; n + per <= count; n += per, src += used, dst += used)
+		{
+			__m256d v = _mm256_loadu_pd( src );
+			v = _mm256_castps_pd( _mm256_permutevar8x32_ps( _mm256_castpd_ps( v ), vctrl ) );
+			_mm256_storeu_pd( dst, _mm256_xor_pd( v, vsign ) );
+		}
+	}
+	else
+	{
+		for (; n + per <= count; n += per, src += used, dst += used)
+		{
+			__m256d v = _mm256_maskload_pd( src, vmask );
+			v = _mm256_castps_pd( _mm256_permutevar8x32_ps( _mm256_castpd_ps( v ), vctrl ) );
+			_mm256_maskstore_pd( dst, vmask, _mm256_xor_pd( v, vsign ) );
+		}
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+// Elements of more than 4 doubles (matrices) are gathered 4 output lanes at a time.
+COB_TARGET("avx2")
+static void permuteGatherAvx2( const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int chunks = (L + 3) / 4;
+	const int MAX_CHUNKS = (MAX_LANES + 3) / 4;
+
+	__m128i vindex[MAX_CHUNKS];
+	__m256d vsign[MAX_CHUNKS];
+	__m256i vmask[MAX_CHUNKS];
+	for (int c = 0; c < chunks; ++c)
+	{
+		int index[4];
+		unsigned long long sign[4];
+		long long mask[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			int lane = c * 4 + k;
+			bool valid = lane < L;
+			index[k] = valid ? p.index[lane] : 0;
+			sign[k] = (valid && p.negate[lane]) ? SIGN_BIT_64 : 0;
+			mask[k] = valid ? -1 : 0;
+		}
+		vindex[c] = _mm_loadu_si128( reinterpret_cast<const __m128i *>(index) );
+		vsign[c] = _mm256_castsi256_pd( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(sign) ) );
+		vmask[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+	}
+
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		// Gather the whole element before storing so src and dst can be the same array
+		__m256d v[MAX_CHUNKS];
+		for (int c = 0; c < chunks; ++c)
+		{
+			v[c] = _mm256_mask_i32gather_pd( _mm256_setzero_pd(), src, vindex[c], _mm256_castsi256_pd( vmask[c] ), 8 );
+		}
+		for (int c = 0; c < chunks; ++c)
+		{
+			_mm256_maskstore_pd( dst + c * 4, vmask[c], _mm256_xor_pd( v[c], vsign[c] ) );
+		}
+	}
+}
+
+void permuteBatchAvx2( const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 4 ))
+	{
+		permuteBounced( permuteBatchAvx2, p, dst, count );
+	}
+	else if (p.lanes <= 4)
+	{
+		permuteShuffleAvx2( p, src, dst, count );
+	}
+	else
+	{
+		permuteGatherAvx2( p, src, dst, count );
+	}
+}
+
+// Elements of up to 8 floats.
+COB_TARGET("avx2")
+static void permuteShuffleAvx2( const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int per = 8 / L;
+	const int used = per * L;
+
+	int ctrl[8];
+	unsigned int sign[8];
+	int mask[8];
+	for (int k = 0; k < 8; ++k)
+	{
+		int from = k;
+		bool negate = false;
+		if (k < used)
+		{
+			from = (k / L) * L + p.index[k % L];
+			negate = p.negate[k % L];
+		}
+		ctrl[k] = from;
+		sign[k] = negate ? SIGN_BIT_32 : 0;
+		mask[k] = (k < used) ? -1 : 0;
+	}
+
+	const __m256i vctrl = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(ctrl) );
+	const __m256 vsign = _mm256_castsi256_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(sign) ) );
+	const __m256i vmask = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+
+	size_t n = 0;
+	if (used == 8)
+	{
+		for (; n + per <= count; n += per, src += used, dst += used)
+		{
+			__m256 v = _mm256_permutevar8x32_ps( _mm256_loadu_ps( src ), vctrl );
+			_mm256_storeu_ps( dst, _mm256_xor_ps( v, vsign ) );
+		}
+	}
+	else
+	{
+		for (; n + per <= count; n += per, src += used, dst += used)
+		{
+			__m256 v = _mm256_permutevar8x32_ps( _mm256_maskload_ps( src, vmask ), vctrl );
+			_mm256_maskstore_ps( dst, vmask, _mm256_xor_ps( v, vsign ) );
+		}
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+// Elements of more than 8 floats (matrices) are gathered 8 output lanes at a time.
+COB_TARGET("avx2")
+static void permuteGatherAvx2( const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int chunks = (L + 7) / 8;
+	const int MAX_CHUNKS = (MAX_LANES + 7) / 8;
+
+	__m256i vindex[MAX_CHUNKS];
+	__m256 vsign[MAX_CHUNKS];
+	__m256i vmask[MAX_CHUNKS];
+	for (int c = 0; c < chunks; ++c)
+	{
+		int index[8];
+		unsigned int sign[8];
+		int mask[8];
+		for (int k = 0; k < 8; ++k)
+		{
+			int lane = c * 8 + k;
+			bool valid = lane < L;
+			index[k] = valid ? p.index[lane] : 0;
+			sign[k] = (valid && p.negate[lane]) ? SIGN_BIT_32 : 0;
+			mask[k] = valid ? -1 : 0;
+		}
+		vindex[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(index) );
+		vsign[c] = _mm256_castsi256_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(sign) ) );
+		vmask[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+	}
+
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		__m256 v[MAX_CHUNKS];
+		for (int c = 0; c < chunks; ++c)
+		{
+			v[c] = _mm256_mask_i32gather_ps( _mm256_setzero_ps(), src, vindex[c], _mm256_castsi256_ps( vmask[c] ), 4 );
+		}
+		for (int c = 0; c < chunks; ++c)
+		{
+			_mm256_maskstore_ps( dst + c * 8, vmask[c], _mm256_xor_ps( v[c], vsign[c] ) );
+		}
+	}
+}
+
+void permuteBatchAvx2( const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 8 ))
+	{
+		permuteBounced( permuteBatchAvx2, p, dst, count );
+	}
+	else if (p.lanes <= 8)
+	{
+		permuteShuffleAvx2( p, src, dst, count );
+	}
+	else
+	{
+		permuteGatherAvx2( p, src, dst, count );
+	}
+}
+
+// 32 bit integers use the same permutes as floats.  The sign change is ~v + 1 in the lanes
+// where m is all ones, except that INT32_MIN becomes ~v = INT32_MAX instead of overflowing.
+COB_TARGET("avx2")
+static inline __m256i negateSaturate32Avx2( __m256i v, __m256i m )
+{
+	const __m256i plusOne = _mm256_andnot_si256( _mm256_cmpeq_epi32( v, _mm256_set1_epi32( INT32_MIN ) ), m );
+	return _mm256_sub_epi32( _mm256_xor_si256( v, m ), plusOne );
+}
+
+COB_TARGET("avx2")
+static void permuteShuffleAvx2( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int per = 8 / L;
+	const int used = per * L;
+
+	int ctrl[8];
+	int negate[8];
+	int mask[8];
+	for (int k = 0; k < 8; ++k)
+	{
+		bool valid = k < used;
+		ctrl[k] = valid ? (k / L) * L + p.index[k % L] : k;
+		negate[k] = (valid && p.negate[k % L]) ? -1 : 0;
+		mask[k] = valid ? -1 : 0;
+	}
+
+	const __m256i vctrl = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(ctrl) );
+	const __m256i vnegate = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(negate) );
+	const __m256i vmask = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+
+	size_t n = 0;
+	for (; n + per <= count; n += per, src += used, dst += used)
+	{
+		__m256i v = _mm256_maskload_epi32( reinterpret_cast<const int *>(src), vmask );
+		v = negateSaturate32Avx2( _mm256_permutevar8x32_epi32( v, vctrl ), vnegate );
+		_mm256_maskstore_epi32( reinterpret_cast<int *>(dst), vmask, v );
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+COB_TARGET("avx2")
+static void permuteGatherAvx2( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int chunks = (L + 7) / 8;
+	const int MAX_CHUNKS = (MAX_LANES + 7) / 8;
+
+	__m256i vindex[MAX_CHUNKS];
+	__m256i vnegate[MAX_CHUNKS];
+	__m256i vmask[MAX_CHUNKS];
+	for (int c = 0; c < chunks; ++c)
+	{
+		int index[8];
+		int negate[8];
+		int mask[8];
+		for (int k = 0; k < 8; ++k)
+		{
+			int lane = c * 8 + k;
+			bool valid = lane < L;
+			index[k] = valid ? p.index[lane] : 0;
+			negate[k] = (valid && p.negate[lane]) ? -1 : 0;
+			mask[k] = valid ? -1 : 0;
+		}
+		vindex[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(index) );
+		vnegate[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(negate) );
+		vmask[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+	}
+
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		__m256i v[MAX_CHUNKS];
+		for (int c = 0; c < chunks; ++c)
+		{
+			v[c] = _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), reinterpret_cast<const int *>(src), vindex[c], vmask[c], 4 );
+		}
+		for (int c = 0; c < chunks; ++c)
+		{
+			_mm256_maskstore_epi32( reinterpret_cast<int *>(dst) + c * 8, vmask[c], negateSaturate32Avx2( v[c], vnegate[c] ) );
+		}
+	}
+}
+
+void permuteBatchAvx2( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 8 ))
+	{
+		permuteBounced( permuteBatchAvx2, p, dst, count );
+	}
+	else if (p.lanes <= 8)
+	{
+		permuteShuffleAvx2( p, src, dst, count );
+	}
+	else
+	{
+		permuteGatherAvx2( p, src, dst, count );
+	}
+}
+
+// 16 bit lanes.  AVX2 has no cross lane 16 bit permute so 16 bytes are shuffled at a time
+// with a byte shuffle, which is enough for one element of up to 16 lanes.  Half floats
+// flip the sign bit and int16_t saturates with a saturating subtract.
+template <bool Saturate>
+COB_TARGET("avx2")
+static inline __m128i changeSign16( __m128i v, __m128i m )
+{
+	return Saturate ? _mm_subs_epi16( _mm_xor_si128( v, m ), m ) : _mm_xor_si128( v, _mm_and_si128( m, _mm_set1_epi16( static_cast<short>(SIGN_BIT_16) ) ) );
+}
+
+// Byte shuffle controls that put source lane index[k] of the 16 bytes at offset
+// from into lane k, and zero the lanes that come from the other 16 bytes.
+static void setByteShuffle( const int *index, int from, char *ctrl )
+{
+	for (int k = 0; k < 8; ++k)
+	{
+		const int lane = index[k] - from;
+		const bool inside = lane >= 0 && lane < 8;
+		ctrl[2 * k] = inside ? static_cast<char>(2 * lane) : static_cast<char>(0x80);
+		ctrl[2 * k + 1] = inside ? static_cast<char>(2 * lane + 1) : static_cast<char>(0x80);
+	}
+}
+
+// The whole 16 or 32 bytes are loaded and stored even when fewer lanes are used, so the loop
+// stops while that still fits in the arrays and the rest goes through the scalar kernel.
+// The unused lanes are copied through unchanged and rewritten by the next element.
+template <bool Saturate, typename T>
+COB_TARGET("avx2")
+static void permute16Avx2( const LanePermutation &p, const T *src, T *dst, size_t count )
+{
+	const int L = p.lanes;
+	const size_t total = count * L;
+
+	if (L <= 8)
+	{
+		const int per = 8 / L;
+		const int used = per * L;
+
+		int index[8];
+		short negate[8];
+		for (int k = 0; k < 8; ++k)
+		{
+			bool valid = k < used;
+			index[k] = valid ? (k / L) * L + p.index[k % L] : k;
+			negate[k] = (valid && p.negate[k % L]) ? -1 : 0;
+		}
+
+		char ctrl[16];
+		setByteShuffle( index, 0, ctrl );
+		const __m128i vctrl = _mm_loadu_si128( reinterpret_cast<const __m128i *>(ctrl) );
+		const __m128i vnegate = _mm_loadu_si128( reinterpret_cast<const __m128i *>(negate) );
+
+		size_t n = 0;
+		for (; n * L + 8 <= total; n += per, src += used, dst += used)
+		{
+			__m128i v = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i *>(src) ), vctrl );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(dst), changeSign16<Saturate>( v, vnegate ) );
+		}
+
+		permuteBatchScalar( p, src, dst, count - n );
+		return;
+	}
+
+	// One element in two halves.  Each output half is shuffled from both input halves.
+	int index[16];
+	short negate[16];
+	for (int k = 0; k < 16; ++k)
+	{
+		bool valid = k < L;
+		index[k] = valid ? p.index[k] : k;
+		negate[k] = (valid && p.negate[k]) ? -1 : 0;
+	}
+
+	__m128i vctrl[2][2];
+	for (int c = 0; c < 2; ++c)
+	{
+		for (int h = 0; h < 2; ++h)
+		{
+			char ctrl[16];
+			setByteShuffle( index + c * 8, h * 8, ctrl );
+			vctrl[c][h] = _mm_loadu_si128( reinterpret_cast<const __m128i *>(ctrl) );
+		}
+	}
+	const __m128i vnegate0 = _mm_loadu_si128( reinterpret_cast<const __m128i *>(negate) );
+	const __m128i vnegate1 = _mm_loadu_si128( reinterpret_cast<const __m128i *>(negate + 8) );
+
+	size_t n = 0;
+	for (; n * L + 16 <= total; ++n, src += L, dst += L)
+	{
+		const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i *>(src) );
+		const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i *>(src + 8) );
+		__m128i lo = _mm_or_si128( _mm_shuffle_epi8( a, vctrl[0][0] ), _mm_shuffle_epi8( b, vctrl[0][1] ) );
+		__m128i hi = _mm_or_si128( _mm_shuffle_epi8( a, vctrl[1][0] ), _mm_shuffle_epi8( b, vctrl[1][1] ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i *>(dst), changeSign16<Saturate>( lo, vnegate0 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i *>(dst + 8), changeSign16<Saturate>( hi, vnegate1 ) );
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+void permuteBatchAvx2( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 8 ))
+	{
+		permuteBounced( permuteBatchAvx2, p, dst, count );
+		return;
+	}
+
+	permute16Avx2<false>( p, src, dst, count );
+}
+
+void permuteBatchAvx2( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 8 ))
+	{
+		permuteBounced( permuteBatchAvx2, p, dst, count );
+		return;
+	}
+
+	permute16Avx2<true>( p, src, dst, count );
+}
+
+// Same as oneCaseEnd() but compares 8 case numbers at a time
+COB_TARGET("avx2")
+static size_t oneCaseEndAvx2( const int *cases, size_t n, size_t count )
+{
+	const __m256i first = _mm256_set1_epi32( cases[n] );
+
+	size_t end = n;
+	while (count - end >= MIXED_BLOCK)
+	{
+		__m256i differ = _mm256_setzero_si256();
+		for (size_t i = 0; i < MIXED_BLOCK; i += 8)
+		{
+			const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(cases + end + i) );
+			differ = _mm256_or_si256( differ, _mm256_xor_si256( v, first ) );
+		}
+		if (!_mm256_testz_si256( differ, differ )) return end;
+		end += MIXED_BLOCK;
+	}
+
+	// The partial block at the end
+	if (end < count && cases[end] == cases[n] && isOneCase( cases + end, count - end )) end = count;
+	return end;
+}
+
+// Elements where each has its own case number.  The permute controls (or gather indices when
+// an element is more than a register) and sign masks of every case are built on the first
+// block with more than one case number.  After that an element costs a table read, a permute
+// or a few gathers, and an XOR.
+COB_TARGET("avx2")
+void permuteMixedAvx2( PermuteDoubleFn kernel, const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count )
+{
+	const int L = m.entry[0].lanes;
+
+	// In place the elements are read from a copy of the block, for the reason in permuteBounced()
+	const bool bounce = src == dst && L % 4 != 0;
+	double buffer[MIXED_BLOCK * MAX_LANES];
+
+	const int chunks = (L + 3) / 4;
+	const int MAX_CHUNKS = (MAX_LANES + 3) / 4;
+
+	__m256i vctrl[MIXED_ENTRIES];
+	__m128i vindex[MIXED_ENTRIES][MAX_CHUNKS];
+	__m256d vsign[MIXED_ENTRIES][MAX_CHUNKS];
+	__m256i vmask[MAX_CHUNKS];
+	for (int c = 0; c < chunks; ++c)
+	{
+		long long mask[4];
+		for (int k = 0; k < 4; ++k) mask[k] = (c * 4 + k < L) ? -1 : 0;
+		vmask[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+	}
+
+	bool built = false;
+	for (size_t n = 0; n < count; )
+	{
+		const size_t end = oneCaseEndAvx2( cases, n, count );
+		if (end > n)
+		{
+			kernel( m.entry[mixedEntry( cases[n] )], src + n * L, dst + n * L, end - n );
+			n = end;
+			continue;
+		}
+
+		if (!built)
+		{
+			for (int e = 0; e < MIXED_ENTRIES; ++e)
+			{
+				const LanePermutation &p = m.entry[e];
+				for (int c = 0; c < chunks; ++c)
+				{
+					// Doubles are permuted as pairs of 32 bit lanes and gathered whole
+					int ctrl[8];
+					int index[4];
+					unsigned long long sign[4];
+					for (int k = 0; k < 4; ++k)
+					{
+						const int lane = c * 4 + k;
+						const bool valid = lane < L;
+						index[k] = valid ? p.index[lane] : 0;
+						ctrl[2 * k] = 2 * (valid ? p.index[lane] : k);
+						ctrl[2 * k + 1] = ctrl[2 * k] + 1;
+						sign[k] = (valid && p.negate[lane]) ? SIGN_BIT_64 : 0;
+					}
+					if (c == 0) vctrl[e] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(ctrl) );
+					vindex[e][c] = _mm_loadu_si128( reinterpret_cast<const __m128i *>(index) );
+					vsign[e][c] = _mm256_castsi256_pd( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(sign) ) );
+				}
+			}
+			built = true;
+		}
+
+		const size_t b = (count - n < MIXED_BLOCK) ? count - n : MIXED_BLOCK;
+		const double *s = src + n * L;
+		double *d = dst + n * L;
+		if (bounce)
+		{
+			memcpy( buffer, s, b * L * sizeof(double) );
+			s = buffer;
+		}
+		if (L == 4)
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+				__m256d v = _mm256_loadu_pd( s );
+				v = _mm256_castps_pd( _mm256_permutevar8x32_ps( _mm256_castpd_ps( v ), vctrl[e] ) );
+				_mm256_storeu_pd( d, _mm256_xor_pd( v, vsign[e][0] ) );
+			}
+		}
+		else if (L < 4)
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+				__m256d v = _mm256_maskload_pd( s, vmask[0] );
+				v = _mm256_castps_pd( _mm256_permutevar8x32_ps( _mm256_castpd_ps( v ), vctrl[e] ) );
+				_mm256_maskstore_pd( d, vmask[0], _mm256_xor_pd( v, vsign[e][0] ) );
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+
+				// Gather the whole element before storing so src and dst can be the same array
+				__m256d v[MAX_CHUNKS];
+				for (int c = 0; c < chunks; ++c)
+				{
+					v[c] = _mm256_mask_i32gather_pd( _mm256_setzero_pd(), s, vindex[e][c], _mm256_castsi256_pd( vmask[c] ), 8 );
+				}
+				for (int c = 0; c < chunks; ++c)
+				{
+					_mm256_maskstore_pd( d + c * 4, vmask[c], _mm256_xor_pd( v[c], vsign[e][c] ) );
+				}
+			}
+		}
+		n += b;
+	}
+}
+
+COB_TARGET("avx2")
+void permuteMixedAvx2( PermuteFloatFn kernel, const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count )
+{
+	const int L = m.entry[0].lanes;
+
+	// In place the elements are read from a copy of the block, for the reason in permuteBounced()
+	const bool bounce = src == dst && L % 8 != 0;
+	float buffer[MIXED_BLOCK * MAX_LANES];
+
+	const int chunks = (L + 7) / 8;
+	const int MAX_CHUNKS = (MAX_LANES + 7) / 8;
+
+	__m256i vindex[MIXED_ENTRIES][MAX_CHUNKS];
+	__m256 vsign[MIXED_ENTRIES][MAX_CHUNKS];
+	__m256i vmask[MAX_CHUNKS];
+	for (int c = 0; c < chunks; ++c)
+	{
+		int mask[8];
+		for (int k = 0; k < 8; ++k) mask[k] = (c * 8 + k < L) ? -1 : 0;
+		vmask[c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(mask) );
+	}
+
+	bool built = false;
+	for (size_t n = 0; n < count; )
+	{
+		const size_t end = oneCaseEndAvx2( cases, n, count );
+		if (end > n)
+		{
+			kernel( m.entry[mixedEntry( cases[n] )], src + n * L, dst + n * L, end - n );
+			n = end;
+			continue;
+		}
+
+		if (!built)
+		{
+			// The same indices are the permute control when an element fits in one register
+			for (int e = 0; e < MIXED_ENTRIES; ++e)
+			{
+				const LanePermutation &p = m.entry[e];
+				for (int c = 0; c < chunks; ++c)
+				{
+					int index[8];
+					unsigned int sign[8];
+					for (int k = 0; k < 8; ++k)
+					{
+						const int lane = c * 8 + k;
+						const bool valid = lane < L;
+						index[k] = valid ? p.index[lane] : k;
+						sign[k] = (valid && p.negate[lane]) ? SIGN_BIT_32 : 0;
+					}
+					vindex[e][c] = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(index) );
+					vsign[e][c] = _mm256_castsi256_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(sign) ) );
+				}
+			}
+			built = true;
+		}
+
+		const size_t b = (count - n < MIXED_BLOCK) ? count - n : MIXED_BLOCK;
+		const float *s = src + n * L;
+		float *d = dst + n * L;
+		if (bounce)
+		{
+			memcpy( buffer, s, b * L * sizeof(float) );
+			s = buffer;
+		}
+		if (L <= 8)
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+				__m256 v = _mm256_permutevar8x32_ps( _mm256_maskload_ps( s, vmask[0] ), vindex[e][0] );
+				_mm256_maskstore_ps( d, vmask[0], _mm256_xor_ps( v, vsign[e][0] ) );
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+
+				__m256 v[MAX_CHUNKS];
+				for (int c = 0; c < chunks; ++c)
+				{
+					v[c] = _mm256_mask_i32gather_ps( _mm256_setzero_ps(), s, vindex[e][c], _mm256_castsi256_ps( vmask[c] ), 4 );
+				}
+				for (int c = 0; c < chunks; ++c)
+				{
+					_mm256_maskstore_ps( d + c * 8, vmask[c], _mm256_xor_ps( v[c], vsign[e][c] ) );
+				}
+			}
+		}
+		n += b;
+	}
+}
+
+// Non-temporal copy.  The bytes before the first 32 byte boundary and after the last one
+// are copied with normal stores.
+COB_TARGET("avx2")
+void streamCopyAvx2( void *dst, const void *src, size_t bytes )
+{
+	unsigned char *d = static_cast<unsigned char *>(dst);
+	const unsigned char *s = static_cast<const unsigned char *>(src);
+
+	size_t head = (32 - (reinterpret_cast<size_t>(d) & 31)) & 31;
+	if (head > bytes) head = bytes;
+	memcpy( d, s, head );
+	d += head;
+	s += head;
+	bytes -= head;
+
+	for (; bytes >= 32; bytes -= 32, d += 32, s += 32)
+	{
+		_mm256_stream_si256( reinterpret_cast<__m256i *>(d), _mm256_loadu_si256( reinterpret_cast<const __m256i *>(s) ) );
+	}
+
+	memcpy( d, s, bytes );
+}
+
+// The reverse of streamCopyAvx2(): src is read with streaming loads and dst is written normally
+COB_TARGET("avx2")
+void streamLoadAvx2( void *dst, const void *src, size_t bytes )
+{
+	unsigned char *d = static_cast<unsigned char *>(dst);
+	const unsigned char *s = static_cast<const unsigned char *>(src);
+
+	size_t head = (32 - (reinterpret_cast<size_t>(s) & 31)) & 31;
+	if (head > bytes) head = bytes;
+	memcpy( d, s, head );
+	d += head;
+	s += head;
+	bytes -= head;
+
+	for (; bytes >= 32; bytes -= 32, d += 32, s += 32)
+	{
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>(d), _mm256_stream_load_si256( reinterpret_cast<const __m256i *>(s) ) );
+	}
+
+	memcpy( d, s, bytes );
+}
+
+COB_TARGET("avx2")
+void streamFenceAvx2()
+{
+	_mm_sfence();
+}
+
+#endif // COB_HAVE_AVX2
+
+#ifdef COB_HAVE_SSE2
+
+// Same as streamCopyAvx2() with 16 byte stores, for CPUs without AVX2
+void streamCopySse2( void *dst, const void *src, size_t bytes )
+{
+	unsigned char *d = static_cast<unsigned char *>(dst);
+	const unsigned char *s = static_cast<const unsigned char *>(src);
+
+	size_t head = (16 - (reinterpret_cast<size_t>(d) & 15)) & 15;
+	if (head > bytes) head = bytes;
+	memcpy( d, s, head );
+	d += head;
+	s += head;
+	bytes -= head;
+
+	for (; bytes >= 16; bytes -= 16, d += 16, s += 16)
+	{
+		_mm_stream_si128( reinterpret_cast<__m128i *>(d), _mm_loadu_si128( reinterpret_cast<const __m128i *>(s) ) );
+	}
+
+	memcpy( d, s, bytes );
+}
+
+void streamFenceSse2()
+{
+	_mm_sfence();
+}
+
+#endif // COB_HAVE_SSE2
+
+#ifdef COB_HAVE_AVX512
+
+// Doubles: elements of up to 8 lanes are packed as many per register as fit.  Elements of
+// 9 to 16 lanes (matrices) are loaded into two registers and use a two-source permute.
+COB_TARGET("avx512f")
+void permuteBatchAvx512( const LanePermutation &p, const double *src, double *dst, size_t count )
+{
+	const int L = p.lanes;
+	if (src == dst && !fillsRegisters( L, 8 ))
+	{
+		permuteBounced( permuteBatchAvx512, p, dst, count );
+		return;
+	}
+
+	if (L <= 8)
+	{
+		const int per = 8 / L;
+		const int used = per * L;
+
+		long long index[8];
+		unsigned long long sign[8];
+		for (int k = 0; k < 8; ++k)
+		{
+			bool valid = k < used;
+			index[k] = valid ? (k / L) * L + p.index[k % L] : k;
+			sign[k] = (valid && p.negate[k % L]) ? SIGN_BIT_64 : 0;
+		}
+
+		const __m512i vindex = _mm512_loadu_si512( index );
+		const __m512i vsign = _mm512_loadu_si512( sign );
+		const __mmask8 kmask = static_cast<__mmask8>((1u << used) - 1);
+
+		size_t n = 0;
+		for (; n + per <= count; n += per, src += used, dst += used)
+		{
+			__m512d v = _mm512_maskz_loadu_pd( kmask, src );
+			v = _mm512_maskz_permutexvar_pd( kmask, vindex, v );
+			v = _mm512_castsi512_pd( _mm512_xor_si512( _mm512_castpd_si512( v ), vsign ) );
+			_mm512_mask_storeu_pd( dst, kmask, v );
+		}
+
+		permuteBatchScalar( p, src, dst, count - n );
+		return;
+	}
+
+	long long index[2][8];
+	unsigned long long sign[2][8];
+	for (int c = 0; c < 2; ++c)
+	{
+		for (int k = 0; k < 8; ++k)
+		{
+			int lane = c * 8 + k;
+			bool valid = lane < L;
+			index[c][k] = valid ? p.index[lane] : 0;
+			sign[c][k] = (valid && p.negate[lane]) ? SIGN_BIT_64 : 0;
+		}
+	}
+
+	const __m512i vindex0 = _mm512_loadu_si512( index[0] );
+	const __m512i vindex1 = _mm512_loadu_si512( index[1] );
+	const __m512i vsign0 = _mm512_loadu_si512( sign[0] );
+	const __m512i vsign1 = _mm512_loadu_si512( sign[1] );
+	const __mmask8 khigh = static_cast<__mmask8>((1u << (L - 8)) - 1);
+
+	for (size_t n = 0; n < count; ++n, src += L, dst += L)
+	{
+		__m512d a = _mm512_loadu_pd( src );
+		__m512d b = _mm512_maskz_loadu_pd( khigh, src + 8 );
+		__m512d lo = _mm512_permutex2var_pd( a, vindex0, b );
+		__m512d hi = _mm512_permutex2var_pd( a, vindex1, b );
+		lo = _mm512_castsi512_pd( _mm512_xor_si512( _mm512_castpd_si512( lo ), vsign0 ) );
+		hi = _mm512_castsi512_pd( _mm512_xor_si512( _mm512_castpd_si512( hi ), vsign1 ) );
+		_mm512_storeu_pd( dst, lo );
+		_mm512_mask_storeu_pd( dst + 8, khigh, hi );
+	}
+}
+
+// Floats: every element fits in one 16 lane register.
+COB_TARGET("avx512f")
+void permuteBatchAvx512( const LanePermutation &p, const float *src, float *dst, size_t count )
+{
+	const int L = p.lanes;
+	if (src == dst && !fillsRegisters( L, 16 ))
+	{
+		permuteBounced( permuteBatchAvx512, p, dst, count );
+		return;
+	}
+
+	const int per = 16 / L;
+	const int used = per * L;
+
+	int index[16];
+	unsigned int sign[16];
+	for (int k = 0; k < 16; ++k)
+	{
+		bool valid = k < used;
+		index[k] = valid ? (k / L) * L + p.index[k % L] : k;
+		sign[k] = (valid && p.negate[k % L]) ? SIGN_BIT_32 : 0;
+	}
+
+	const __m512i vindex = _mm512_loadu_si512( index );
+	const __m512i vsign = _mm512_loadu_si512( sign );
+	const __mmask16 kmask = static_cast<__mmask16>((1u << used) - 1);
+
+	size_t n = 0;
+	for (; n + per <= count; n += per, src += used, dst += used)
+	{
+		__m512 v = _mm512_maskz_loadu_ps( kmask, src );
+		v = _mm512_maskz_permutexvar_ps( kmask, vindex, v );
+		v = _mm512_castsi512_ps( _mm512_xor_si512( _mm512_castps_si512( v ), vsign ) );
+		_mm512_mask_storeu_ps( dst, kmask, v );
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+// 32 bit integers: every element fits in one 16 lane register.  Negating INT32_MIN
+// saturates to INT32_MAX.
+COB_TARGET("avx512f")
+void permuteBatchAvx512( const LanePermutation &p, const int32_t *src, int32_t *dst, size_t count )
+{
+	const int L = p.lanes;
+	if (src == dst && !fillsRegisters( L, 16 ))
+	{
+		permuteBounced( permuteBatchAvx512, p, dst, count );
+		return;
+	}
+
+	const int per = 16 / L;
+	const int used = per * L;
+
+	int index[16];
+	unsigned int negate = 0;
+	for (int k = 0; k < 16; ++k)
+	{
+		bool valid = k < used;
+		index[k] = valid ? (k / L) * L + p.index[k % L] : k;
+		if (valid && p.negate[k % L]) negate |= 1u << k;
+	}
+
+	const __m512i vindex = _mm512_loadu_si512( index );
+	const __m512i vzero = _mm512_setzero_si512();
+	const __m512i vmin = _mm512_set1_epi32( INT32_MIN );
+	const __m512i vmax = _mm512_set1_epi32( INT32_MAX );
+	const __mmask16 kmask = static_cast<__mmask16>((1u << used) - 1);
+	const __mmask16 knegate = static_cast<__mmask16>(negate);
+
+	size_t n = 0;
+	for (; n + per <= count; n += per, src += used, dst += used)
+	{
+		__m512i v = _mm512_maskz_loadu_epi32( kmask, src );
+		v = _mm512_maskz_permutexvar_epi32( kmask, vindex, v );
+		const __mmask16 kmin = _mm512_mask_cmpeq_epi32_mask( knegate, v, vmin );
+		v = _mm512_mask_sub_epi32( v, knegate, vzero, v );
+		v = _mm512_mask_mov_epi32( v, kmin, vmax );
+		_mm512_mask_storeu_epi32( dst, kmask, v );
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+// 16 bit lanes: every element fits in one 32 lane register.  The 16 bit permute is AVX-512BW.
+// Half floats flip the sign bit and int16_t uses a saturating subtract.
+template <bool Saturate, typename T>
+COB_TARGET("avx512f,avx512bw")
+static void permute16Avx512( const LanePermutation &p, const T *src, T *dst, size_t count )
+{
+	const int L = p.lanes;
+	const int per = 32 / L;
+	const int used = per * L;
+
+	short index[32];
+	unsigned short sign[32];
+	unsigned int negate = 0;
+	for (int k = 0; k < 32; ++k)
+	{
+		bool valid = k < used;
+		index[k] = static_cast<short>(valid ? (k / L) * L + p.index[k % L] : k);
+		sign[k] = (valid && p.negate[k % L]) ? SIGN_BIT_16 : 0;
+		if (valid && p.negate[k % L]) negate |= 1u << k;
+	}
+
+	const __m512i vindex = _mm512_loadu_si512( index );
+	const __m512i vsign = _mm512_loadu_si512( sign );
+	const __m512i vzero = _mm512_setzero_si512();
+	const __mmask32 kmask = static_cast<__mmask32>((used == 32) ? 0xFFFFFFFFu : ((1u << used) - 1));
+	const __mmask32 knegate = static_cast<__mmask32>(negate);
+
+	size_t n = 0;
+	for (; n + per <= count; n += per, src += used, dst += used)
+	{
+		__m512i v = _mm512_maskz_loadu_epi16( kmask, src );
+		v = _mm512_maskz_permutexvar_epi16( kmask, vindex, v );
+		v = Saturate ? _mm512_mask_subs_epi16( v, knegate, vzero, v ) : _mm512_xor_si512( v, vsign );
+		_mm512_mask_storeu_epi16( dst, kmask, v );
+	}
+
+	permuteBatchScalar( p, src, dst, count - n );
+}
+
+void permuteBatchAvx512( const LanePermutation &p, const uint16_t *src, uint16_t *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 32 ))
+	{
+		permuteBounced( permuteBatchAvx512, p, dst, count );
+		return;
+	}
+
+	permute16Avx512<false>( p, src, dst, count );
+}
+
+void permuteBatchAvx512( const LanePermutation &p, const int16_t *src, int16_t *dst, size_t count )
+{
+	if (src == dst && !fillsRegisters( p.lanes, 32 ))
+	{
+		permuteBounced( permuteBatchAvx512, p, dst, count );
+		return;
+	}
+
+	permute16Avx512<true>( p, src, dst, count );
+}
+
+// Elements where each has its own case number.  Every element of up to 16 lanes is one or two
+// registers, so an element is a masked load, a permute and a masked XOR of the sign bits.  The
+// tables are bytes and bit masks so all 49 cases stay small.
+static void buildMixedTable( const MixedPermutation &m, unsigned char index[][16], unsigned short negate[] )
+{
+	const int L = m.entry[0].lanes;
+	for (int e = 0; e < MIXED_ENTRIES; ++e)
+	{
+		negate[e] = 0;
+		for (int k = 0; k < 16; ++k)
+		{
+			const bool valid = k < L;
+			index[e][k] = static_cast<unsigned char>(valid ? m.entry[e].index[k] : k);
+			if (valid && m.entry[e].negate[k]) negate[e] = static_cast<unsigned short>(negate[e] | (1u << k));
+		}
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteMixedAvx512( PermuteDoubleFn kernel, const MixedPermutation &m, const int *cases, const double *src, double *dst, size_t count )
+{
+	const int L = m.entry[0].lanes;
+
+	// In place the elements are read from a copy of the block, for the reason in permuteBounced()
+	const bool bounce = src == dst && L % 8 != 0;
+	double buffer[MIXED_BLOCK * MAX_LANES];
+
+	const __mmask8 klow = static_cast<__mmask8>((L >= 8) ? 0xFF : (1u << L) - 1);
+	const __mmask8 khigh = static_cast<__mmask8>((L > 8) ? (1u << (L - 8)) - 1 : 0);
+	const __m512i signBit = _mm512_set1_epi64( static_cast<long long>(SIGN_BIT_64) );
+
+	unsigned char index[MIXED_ENTRIES][16];
+	unsigned short negate[MIXED_ENTRIES];
+	bool built = false;
+
+	for (size_t n = 0; n < count; )
+	{
+		const size_t end = oneCaseEndAvx2( cases, n, count );
+		if (end > n)
+		{
+			kernel( m.entry[mixedEntry( cases[n] )], src + n * L, dst + n * L, end - n );
+			n = end;
+			continue;
+		}
+
+		if (!built)
+		{
+			buildMixedTable( m, index, negate );
+			built = true;
+		}
+
+		const size_t b = (count - n < MIXED_BLOCK) ? count - n : MIXED_BLOCK;
+		const double *s = src + n * L;
+		double *d = dst + n * L;
+		if (bounce)
+		{
+			memcpy( buffer, s, b * L * sizeof(double) );
+			s = buffer;
+		}
+		if (L <= 8)
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+				const __m512i vindex = _mm512_maskz_cvtepu8_epi64( 0xFF, _mm_loadl_epi64( reinterpret_cast<const __m128i *>(index[e]) ) );
+				__m512i v = _mm512_castpd_si512( _mm512_maskz_permutexvar_pd( 0xFF, vindex, _mm512_maskz_loadu_pd( klow, s ) ) );
+				v = _mm512_mask_xor_epi64( v, static_cast<__mmask8>(negate[e]), v, signBit );
+				_mm512_mask_storeu_pd( d, klow, _mm512_castsi512_pd( v ) );
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < b; ++i, s += L, d += L)
+			{
+				const int e = mixedEntry( cases[n + i] );
+				const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i *>(index[e]) );
+				const __m512d a = _mm512_loadu_pd( s );
+				const __m512d c = _mm512_maskz_loadu_pd( khigh, s + 8 );
+				__m512i lo = _mm512_castpd_si512( _mm512_permutex2var_pd( a, _mm512_maskz_cvtepu8_epi64( 0xFF, bytes ), c ) );
+				__m512i hi = _mm512_castpd_si512( _mm512_permutex2var_pd( a, _mm512_maskz_cvtepu8_epi64( 0xFF, _mm_srli_si128( bytes, 8 ) ), c ) );
+				lo = _mm512_mask_xor_epi64( lo, static_cast<__mmask8>(negate[e]), lo, signBit );
+				hi = _mm512_mask_xor_epi64( hi, static_cast<__mmask8>(negate[e] >> 8), hi, signBit );
+				_mm512_storeu_pd( d, _mm512_castsi512_pd( lo ) );
+				_mm512_mask_storeu_pd( d + 8, khigh, _mm512_castsi512_pd( hi ) );
+			}
+		}
+		n += b;
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteMixedAvx512( PermuteFloatFn kernel, const MixedPermutation &m, const int *cases, const float *src, float *dst, size_t count )
+{
+	const int L = m.entry[0].lanes;
+
+	// In place the elements are read from a copy of the block, for the reason in permuteBounced()
+	const bool bounce = src == dst && L % 16 != 0;
+	float buffer[MIXED_BLOCK * MAX_LANES];
+
+	const __mmask16 kmask = static_cast<__mmask16>((1u << L) - 1);
+	const __m512i signBit = _mm512_set1_epi32( static_cast<int>(SIGN_BIT_32) );
+
+	unsigned char index[MIXED_ENTRIES][16];
+	unsigned short negate[MIXED_ENTRIES];
+	bool built = false;
+
+	for (size_t n = 0; n < count; )
+	{
+		const size_t end = oneCaseEndAvx2( cases, n, count );
+		if (end > n)
+		{
+			kernel( m.entry[mixedEntry( cases[n] )], src + n * L, dst + n * L, end - n );
+			n = end;
+			continue;
+		}
+
+		if (!built)
+		{
+			buildMixedTable( m, index, negate );
+			built = true;
+		}
+
+		const size_t b = (count - n < MIXED_BLOCK) ? count - n : MIXED_BLOCK;
+		const float *s = src + n * L;
+		float *d = dst + n * L;
+		if (bounce)
+		{
+			memcpy( buffer, s, b * L * sizeof(float) );
+			s = buffer;
+		}
+		for (size_t i = 0; i < b; ++i, s += L, d += L)
+		{
+			const int e = mixedEntry( cases[n + i] );
+			const __m512i vindex = _mm512_maskz_cvtepu8_epi32( 0xFFFF, _mm_loadu_si128( reinterpret_cast<const __m128i *>(index[e]) ) );
+			__m512i v = _mm512_castps_si512( _mm512_maskz_permutexvar_ps( 0xFFFF, vindex, _mm512_maskz_loadu_ps( kmask, s ) ) );
+			v = _mm512_mask_xor_epi32( v, negate[e], v, signBit );
+			_mm512_mask_storeu_ps( d, kmask, _mm512_castsi512_ps( v ) );
+		}
+		n += b;
+	}
+}
+
+// Fields inside structs: each element is a masked load straight from its struct, a permute
+// and a masked XOR of the sign bits, and a masked store back, so nothing else in the struct
+// is touched.
+COB_TARGET("avx512f")
+void permuteStridedAvx512( const LanePermutation &p, const double *src, size_t srcStride, double *dst, size_t dstStride, size_t count )
+{
+	const int L = p.lanes;
+	const __mmask8 klow = static_cast<__mmask8>((L >= 8) ? 0xFF : (1u << L) - 1);
+	const __mmask8 khigh = static_cast<__mmask8>((L > 8) ? (1u << (L - 8)) - 1 : 0);
+	const __m512i signBit = _mm512_set1_epi64( static_cast<long long>(SIGN_BIT_64) );
+
+	long long index[16];
+	unsigned int negate = 0;
+	for (int k = 0; k < 16; ++k)
+	{
+		index[k] = (k < L) ? p.index[k] : k;
+		if (k < L && p.negate[k]) negate |= 1u << k;
+	}
+	const __m512i indexLow = _mm512_loadu_si512( index );
+	const __m512i indexHigh = _mm512_loadu_si512( index + 8 );
+	const __mmask8 negateLow = static_cast<__mmask8>(negate);
+	const __mmask8 negateHigh = static_cast<__mmask8>(negate >> 8);
+
+	const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
+	unsigned char *d = reinterpret_cast<unsigned char *>(dst);
+	if (L <= 8)
+	{
+		for (size_t n = 0; n < count; ++n, s += srcStride, d += dstStride)
+		{
+			__m512i v = _mm512_castpd_si512( _mm512_maskz_permutexvar_pd( 0xFF, indexLow, _mm512_maskz_loadu_pd( klow, s ) ) );
+			v = _mm512_mask_xor_epi64( v, negateLow, v, signBit );
+			_mm512_mask_storeu_pd( d, klow, _mm512_castsi512_pd( v ) );
+		}
+	}
+	else
+	{
+		for (size_t n = 0; n < count; ++n, s += srcStride, d += dstStride)
+		{
+			const __m512d a = _mm512_loadu_pd( reinterpret_cast<const double *>(s) );
+			const __m512d c = _mm512_maskz_loadu_pd( khigh, s + 64 );
+			__m512i lo = _mm512_castpd_si512( _mm512_permutex2var_pd( a, indexLow, c ) );
+			__m512i hi = _mm512_castpd_si512( _mm512_permutex2var_pd( a, indexHigh, c ) );
+			lo = _mm512_mask_xor_epi64( lo, negateLow, lo, signBit );
+			hi = _mm512_mask_xor_epi64( hi, negateHigh, hi, signBit );
+			_mm512_storeu_pd( d, _mm512_castsi512_pd( lo ) );
+			_mm512_mask_storeu_pd( d + 64, khigh, _mm512_castsi512_pd( hi ) );
+		}
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteStridedAvx512( const LanePermutation &p, const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count )
+{
+	const int L = p.lanes;
+	const __mmask16 kmask = static_cast<__mmask16>((1u << L) - 1);
+	const __m512i signBit = _mm512_set1_epi32( static_cast<int>(SIGN_BIT_32) );
+
+	int index[16];
+	unsigned int negate = 0;
+	for (int k = 0; k < 16; ++k)
+	{
+		index[k] = (k < L) ? p.index[k] : k;
+		if (k < L && p.negate[k]) negate |= 1u << k;
+	}
+	const __m512i vindex = _mm512_loadu_si512( index );
+	const __mmask16 vnegate = static_cast<__mmask16>(negate);
+
+	const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
+	unsigned char *d = reinterpret_cast<unsigned char *>(dst);
+	for (size_t n = 0; n < count; ++n, s += srcStride, d += dstStride)
+	{
+		__m512i v = _mm512_castps_si512( _mm512_maskz_permutexvar_ps( 0xFFFF, vindex, _mm512_maskz_loadu_ps( kmask, s ) ) );
+		v = _mm512_mask_xor_epi32( v, vnegate, v, signBit );
+		_mm512_mask_storeu_ps( d, kmask, _mm512_castsi512_ps( v ) );
+	}
+}
+
+// Packed elements to component arrays and back, a register of elements at a time.  R = 8
+// doubles or 16 floats per register, so R elements of L lanes are L registers.  Every output
+// register takes its values from two pairs of the input registers with two-source permutes
+// and a blend, and flips its sign bits with a masked XOR.  The tables are worked out once per
+// call from p.  The last count % R elements are done one value at a time.
+struct SoATables
+{
+	int low[4][16];			// index into input registers 0 and 1
+	int high[4][16];		// index into input registers 2 and 3
+	unsigned short useHigh[4];
+	unsigned short negate[4];
+};
+
+static void buildToSoATables( const LanePermutation &p, int R, SoATables &t )
+{
+	const int L = p.lanes;
+	for (int k = 0; k < L; ++k)
+	{
+		t.useHigh[k] = 0;
+		t.negate[k] = static_cast<unsigned short>(p.negate[k] ? (1u << R) - 1 : 0);
+		for (int n = 0; n < R; ++n)
+		{
+			// Component k of element n is packed value n * L + index[k]
+			const int q = n * L + p.index[k];
+			t.low[k][n] = q % (2 * R);
+			t.high[k][n] = q % (2 * R);
+			if (q >= 2 * R) t.useHigh[k] = static_cast<unsigned short>(t.useHigh[k] | (1u << n));
+		}
+	}
+}
+
+static void buildFromSoATables( const LanePermutation &p, int R, SoATables &t )
+{
+	const int L = p.lanes;
+	for (int j = 0; j < L; ++j)
+	{
+		t.useHigh[j] = 0;
+		t.negate[j] = 0;
+		for (int i = 0; i < R; ++i)
+		{
+			// Packed value j * R + i is lane k of element n, which is entry n of input register k
+			const int q = j * R + i;
+			const int n = q / L;
+			const int k = q % L;
+			t.low[j][i] = (k & 1) * R + n;
+			t.high[j][i] = (k & 1) * R + n;
+			if (k >= 2) t.useHigh[j] = static_cast<unsigned short>(t.useHigh[j] | (1u << i));
+			if (p.negate[k]) t.negate[j] = static_cast<unsigned short>(t.negate[j] | (1u << i));
+		}
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteToSoAAvx512( const LanePermutation &p, const double *src, double *const *dst, size_t count )
+{
+	const int L = p.lanes;
+	SoATables t;
+	buildToSoATables( p, 8, t );
+
+	__m512i low[4], high[4];
+	for (int k = 0; k < L; ++k)
+	{
+		low[k] = _mm512_maskz_cvtepi32_epi64( 0xFF, _mm256_loadu_si256( reinterpret_cast<const __m256i *>(t.low[k]) ) );
+		high[k] = _mm512_maskz_cvtepi32_epi64( 0xFF, _mm256_loadu_si256( reinterpret_cast<const __m256i *>(t.high[k]) ) );
+	}
+	const __m512i signBit = _mm512_set1_epi64( static_cast<long long>(SIGN_BIT_64) );
+
+	size_t n = 0;
+	for (; n + 8 <= count; n += 8, src += 8 * L)
+	{
+		__m512d in[4];
+		for (int r = 0; r < L; ++r) in[r] = _mm512_loadu_pd( src + r * 8 );
+		if (L == 3) in[3] = in[2];
+
+		for (int k = 0; k < L; ++k)
+		{
+			const __m512d a = _mm512_permutex2var_pd( in[0], low[k], in[1] );
+			const __m512d b = _mm512_permutex2var_pd( in[2], high[k], in[3] );
+			__m512i v = _mm512_castpd_si512( _mm512_mask_blend_pd( static_cast<__mmask8>(t.useHigh[k]), a, b ) );
+			v = _mm512_mask_xor_epi64( v, static_cast<__mmask8>(t.negate[k]), v, signBit );
+			_mm512_storeu_pd( dst[k] + n, _mm512_castsi512_pd( v ) );
+		}
+	}
+
+	for (; n < count; ++n, src += L)
+	{
+		for (int k = 0; k < L; ++k) dst[k][n] = negateIf( src[p.index[k]], p.negate[k] ? 1 : 0 );
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteToSoAAvx512( const LanePermutation &p, const float *src, float *const *dst, size_t count )
+{
+	const int L = p.lanes;
+	SoATables t;
+	buildToSoATables( p, 16, t );
+
+	__m512i low[4], high[4];
+	for (int k = 0; k < L; ++k)
+	{
+		low[k] = _mm512_loadu_si512( t.low[k] );
+		high[k] = _mm512_loadu_si512( t.high[k] );
+	}
+	const __m512i signBit = _mm512_set1_epi32( static_cast<int>(SIGN_BIT_32) );
+
+	size_t n = 0;
+	for (; n + 16 <= count; n += 16, src += 16 * L)
+	{
+		__m512 in[4];
+		for (int r = 0; r < L; ++r) in[r] = _mm512_loadu_ps( src + r * 16 );
+		if (L == 3) in[3] = in[2];
+
+		for (int k = 0; k < L; ++k)
+		{
+			const __m512 a = _mm512_permutex2var_ps( in[0], low[k], in[1] );
+			const __m512 b = _mm512_permutex2var_ps( in[2], high[k], in[3] );
+			__m512i v = _mm512_castps_si512( _mm512_mask_blend_ps( t.useHigh[k], a, b ) );
+			v = _mm512_mask_xor_epi32( v, t.negate[k], v, signBit );
+			_mm512_storeu_ps( dst[k] + n, _mm512_castsi512_ps( v ) );
+		}
+	}
+
+	for (; n < count; ++n, src += L)
+	{
+		for (int k = 0; k < L; ++k) dst[k][n] = negateIf( src[p.index[k]], p.negate[k] ? 1 : 0 );
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteFromSoAAvx512( const LanePermutation &p, const double *const *src, double *dst, size_t count )
+{
+	const int L = p.lanes;
+	SoATables t;
+	buildFromSoATables( p, 8, t );
+
+	__m512i low[4], high[4];
+	const double *in[4];
+	for (int j = 0; j < L; ++j)
+	{
+		low[j] = _mm512_maskz_cvtepi32_epi64( 0xFF, _mm256_loadu_si256( reinterpret_cast<const __m256i *>(t.low[j]) ) );
+		high[j] = _mm512_maskz_cvtepi32_epi64( 0xFF, _mm256_loadu_si256( reinterpret_cast<const __m256i *>(t.high[j]) ) );
+		in[j] = src[p.index[j]];
+	}
+	const __m512i signBit = _mm512_set1_epi64( static_cast<long long>(SIGN_BIT_64) );
+
+	size_t n = 0;
+	for (; n + 8 <= count; n += 8, dst += 8 * L)
+	{
+		// Vectors have no fourth array, so their second permute reads the third one twice
+		const __m512d v[4] =
+		{
+			_mm512_loadu_pd( in[0] + n ),
+			_mm512_loadu_pd( in[1] + n ),
+			_mm512_loadu_pd( in[2] + n ),
+			_mm512_loadu_pd( in[(L == 4) ? 3 : 2] + n )
+		};
+
+		for (int j = 0; j < L; ++j)
+		{
+			const __m512d a = _mm512_permutex2var_pd( v[0], low[j], v[1] );
+			const __m512d b = _mm512_permutex2var_pd( v[2], high[j], v[3] );
+			__m512i out = _mm512_castpd_si512( _mm512_mask_blend_pd( static_cast<__mmask8>(t.useHigh[j]), a, b ) );
+			out = _mm512_mask_xor_epi64( out, static_cast<__mmask8>(t.negate[j]), out, signBit );
+			_mm512_storeu_pd( dst + j * 8, _mm512_castsi512_pd( out ) );
+		}
+	}
+
+	for (; n < count; ++n, dst += L)
+	{
+		for (int k = 0; k < L; ++k) dst[k] = negateIf( in[k][n], p.negate[k] ? 1 : 0 );
+	}
+}
+
+COB_TARGET("avx512f")
+void permuteFromSoAAvx512( const LanePermutation &p, const float *const *src, float *dst, size_t count )
+{
+	const int L = p.lanes;
+	SoATables t;
+	buildFromSoATables( p, 16, t );
+
+	__m512i low[4], high[4];
+	const float *in[4];
+	for (int j = 0; j < L; ++j)
+	{
+		low[j] = _mm512_loadu_si512( t.low[j] );
+		high[j] = _mm512_loadu_si512( t.high[j] );
+		in[j] = src[p.index[j]];
+	}
+	const __m512i signBit = _mm512_set1_epi32( static_cast<int>(SIGN_BIT_32) );
+
+	size_t n = 0;
+	for (; n + 16 <= count; n += 16, dst += 16 * L)
+	{
+		// Vectors have no fourth array, so their second permute reads the third one twice
+		const __m512 v[4] =
+		{
+			_mm512_loadu_ps( in[0] + n ),
+			_mm512_loadu_ps( in[1] + n ),
+			_mm512_loadu_ps( in[2] + n ),
+			_mm512_loadu_ps( in[(L == 4) ? 3 : 2] + n )
+		};
+
+		for (int j = 0; j < L; ++j)
+		{
+			const __m512 a = _mm512_permutex2var_ps( v[0], low[j], v[1] );
+			const __m512 b = _mm512_permutex2var_ps( v[2], high[j], v[3] );
+			__m512i out = _mm512_castps_si512( _mm512_mask_blend_ps( t.useHigh[j], a, b ) );
+			out = _mm512_mask_xor_epi32( out, t.negate[j], out, signBit );
+			_mm512_storeu_ps( dst + j * 16, _mm512_castsi512_ps( out ) );
+		}
+	}
+
+	for (; n < count; ++n, dst += L)
+	{
+		for (int k = 0; k < L; ++k) dst[k] = negateIf( in[k][n], p.negate[k] ? 1 : 0 );
+	}
+}
+
+#endif // COB_HAVE_AVX512
+
+} // namespace detail
+} // namespace cob
@@ -0,0 +1,171 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef CHANGEOFBASIS_STATIC_H
+#define	CHANGEOFBASIS_STATIC_H
+
+#include "changeOfBasis.h"
+#include "changeOfBasisInline.h"
+
+// Change of Basis between frames that are known at compile time.
+// The case number is worked out by the compiler and each function turns into a
+// few moves and negations with no lookups or branches.  Converting a frame to
+// itself compiles to nothing.
+//
+// example:
+//   typedef cob::Frame< cob::RIGHT, cob::FORWARD, cob::UP > SensorFrame;
+//   cob::quatCob< SensorFrame, cob::Unreal3FrameType >( q.x, q.y, q.z, q.w );
+
+namespace cob
+{
+	// A reference frame as a type.  A, B and C are the X, Y and Z axes as in triple.
+	template <int A, int B, int C>
+	struct Frame
+	{
+		static constexpr triple value() { return triple( A, B, C ); }
+	};
+
+	// The sample frames from changeOfBasis.h
+	typedef Frame< Unreal3Frame.a, Unreal3Frame.b, Unreal3Frame.c >				Unreal3FrameType;
+	typedef Frame< OpenGLFrame.a, OpenGLFrame.b, OpenGLFrame.c >				OpenGLFrameType;
+	typedef Frame< OculusFrame.a, OculusFrame.b, OculusFrame.c >				OculusFrameType;
+	typedef Frame< BvhFrame.a, BvhFrame.b, BvhFrame.c >							BvhFrameType;
+	typedef Frame< BvhBlenderFrame.a, BvhBlenderFrame.b, BvhBlenderFrame.c >	BvhBlenderFrameType;
+	typedef Frame< KinectFrame.a, KinectFrame.b, KinectFrame.c >				KinectFrameType;
+	typedef Frame< PrioVRFrame.a, PrioVRFrame.b, PrioVRFrame.c >				PrioVRFrameType;
+
+	namespace detail
+	{
+		template <bool Negate, typename T>
+		inline T applySign( T v )
+		{
+			return Negate ? -v : v;
+		}
+
+		// Straight line change of basis code for one case number
+		template <int Case>
+		struct CaseCob
+		{
+			static const int i0 = caseTable[Case].index[0];
+			static const int i1 = caseTable[Case].index[1];
+			static const int i2 = caseTable[Case].index[2];
+			static const bool n0 = caseTable[Case].negate[0] != 0;
+			static const bool n1 = caseTable[Case].negate[1] != 0;
+			static const bool n2 = caseTable[Case].negate[2] != 0;
+			static const bool r = caseTable[Case].reflection != 0;
+
+			template <typename T>
+			static inline void vector( T &vx, T &vy, T &vz )
+			{
+				const T t[3] = { vx, vy, vz };
+				vx = applySign<n0>( t[i0] );
+				vy = applySign<n1>( t[i1] );
+				vz = applySign<n2>( t[i2] );
+			}
+
+			template <typename T>
+			static inline void quat( T &qx, T &qy, T &qz )
+			{
+				const T t[3] = { qx, qy, qz };
+				qx = applySign<n0 != r>( t[i0] );
+				qy = applySign<n1 != r>( t[i1] );
+				qz = applySign<n2 != r>( t[i2] );
+			}
+
+			template <typename T>
+			static inline void pseudoVector( T &vx, T &vy, T &vz )
+			{
+				quat( vx, vy, vz );
+			}
+
+			template <typename T>
+			static inline void matrix(
+				T &a00, T &a01, T &a02,
+				T &a10, T &a11, T &a12,
+				T &a20, T &a21, T &a22 )
+			{
+				const T m[3][3] =
+				{
+					{ a00, a01, a02 },
+					{ a10, a11, a12 },
+					{ a20, a21, a22 }
+				};
+
+				// The diagonal never changes sign
+				a00 = m[i0][i0];                        a01 = applySign<n0 != n1>( m[i0][i1] ); a02 = applySign<n0 != n2>( m[i0][i2] );
+				a10 = applySign<n1 != n0>( m[i1][i0] ); a11 = m[i1][i1];                        a12 = applySign<n1 != n2>( m[i1][i2] );
+				a20 = applySign<n2 != n0>( m[i2][i0] ); a21 = applySign<n2 != n1>( m[i2][i1] ); a22 = m[i2][i2];
+			}
+		};
+
+		// The identity case does nothing at all
+		template <>
+		struct CaseCob<0>
+		{
+			template <typename T>
+			static inline void vector( T &, T &, T & ) {}
+
+			template <typename T>
+			static inline void quat( T &, T &, T & ) {}
+
+			template <typename T>
+			static inline void pseudoVector( T &, T &, T & ) {}
+
+			template <typename T>
+			static inline void matrix( T &, T &, T &, T &, T &, T &, T &, T &, T & ) {}
+		};
+	}
+
+	// The case number between two frames, as a compile time constant.
+	template <class From, class To>
+	constexpr int getCaseNumber()
+	{
+		return detail::caseNumber( From::value(), To::value() );
+	}
+
+	// Same as matrixCob3x3( getCaseNumber( from, to ), ... ) for any scalar type
+	template <class From, class To, typename T>
+	inline void matrixCob3x3(
+		T &a00, T &a01, T &a02,
+		T &a10, T &a11, T &a12,
+		T &a20, T &a21, T &a22 )
+	{
+		detail::CaseCob< getCaseNumber<From, To>() >::matrix( a00, a01, a02, a10, a11, a12, a20, a21, a22 );
+	}
+
+	// Same as vectorCob( getCaseNumber( from, to ), ... ) for any scalar type
+	template <class From, class To, typename T>
+	inline void vectorCob( T &vx, T &vy, T &vz )
+	{
+		detail::CaseCob< getCaseNumber<From, To>() >::vector( vx, vy, vz );
+	}
+
+	// Same as pseudoVectorCob( getCaseNumber( from, to ), ... ) for any scalar type
+	template <class From, class To, typename T>
+	inline void pseudoVectorCob( T &vx, T &vy, T &vz )
+	{
+		detail::CaseCob< getCaseNumber<From, To>() >::pseudoVector( vx, vy, vz );
+	}
+
+	// Same as quatCob( getCaseNumber( from, to ), ... ) for any scalar type
+	template <class From, class To, typename T>
+	inline void quatCob( T &qx, T &qy, T &qz, T & /* qw */ )
+	{
+		detail::CaseCob< getCaseNumber<From, To>() >::quat( qx, qy, qz );
+	}
+}
+
+#endif // CHANGEOFBASIS_STATIC_H
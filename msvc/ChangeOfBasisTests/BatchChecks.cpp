@@ -0,0 +1,932 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasis.h"
+#include "changeOfBasisInline.h"
+#include "changeOfBasisKernels.h"
+#include "BatchChecks.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+#include <vector>
+
+using namespace cob;
+
+// The batch functions must give exactly the same answer as the single element versions.
+// The count is odd and larger than a SIMD register so the leftover elements are checked too.
+
+static const int BATCH_COUNT = 7;
+
+// More than a register of 16 bit vectors
+static const int HALF_BATCH_COUNT = 13;
+
+template <typename T>
+static void checkQuatCobBatch()
+{
+	T in[BATCH_COUNT * 4];
+	T out[BATCH_COUNT * 4];
+	T inPlace[BATCH_COUNT * 4];
+
+	fillValues( in, BATCH_COUNT * 4 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		for (int layout = QUAT_XYZW; layout <= QUAT_WXYZ; ++layout)
+		{
+			const int x = (layout == QUAT_WXYZ) ? 1 : 0;
+			const int w = (layout == QUAT_WXYZ) ? 0 : 3;
+
+			quatCobBatch( caseNumber, layout, in, out, BATCH_COUNT );
+
+			for (int i = 0; i < BATCH_COUNT * 4; ++i) inPlace[i] = in[i];
+			quatCobBatch( caseNumber, layout, inPlace, BATCH_COUNT );
+
+			for (int n = 0; n < BATCH_COUNT; ++n)
+			{
+				const T *q = in + n * 4;
+				double qx(q[x]), qy(q[x + 1]), qz(q[x + 2]), qw(q[w]);
+				quatCob( caseNumber, qx, qy, qz, qw );
+
+				EXPECT_EQ( T(qx), out[n * 4 + x] );
+				EXPECT_EQ( T(qy), out[n * 4 + x + 1] );
+				EXPECT_EQ( T(qz), out[n * 4 + x + 2] );
+				EXPECT_EQ( T(qw), out[n * 4 + w] );
+
+				for (int c = 0; c < 4; ++c)
+				{
+					EXPECT_EQ( out[n * 4 + c], inPlace[n * 4 + c] );
+				}
+			}
+		}
+	}
+}
+
+// Every pair of quaternion formats must match reordering, conjugating and quatCob done
+// one at a time.  Case 48 is invalid and only changes the format.
+template <typename T>
+static void checkQuatFormats()
+{
+	T in[BATCH_COUNT * 4];
+	T out[BATCH_COUNT * 4];
+	T inPlace[BATCH_COUNT * 4];
+
+	fillValues( in, BATCH_COUNT * 4 );
+
+	for (int caseNumber = 0; caseNumber <= 48; ++caseNumber)
+	{
+		for (int f = 0; f < 16; ++f)
+		{
+			const QuatFormat inFormat = { f & 1, (f >> 1) & 1 };
+			const QuatFormat outFormat = { (f >> 2) & 1, (f >> 3) & 1 };
+
+			quatCobBatch( caseNumber, inFormat, outFormat, in, out, BATCH_COUNT );
+
+			for (int i = 0; i < BATCH_COUNT * 4; ++i) inPlace[i] = in[i];
+			quatCobBatch( caseNumber, inFormat, outFormat, inPlace, BATCH_COUNT );
+
+			const int inX = (inFormat.layout == QUAT_WXYZ) ? 1 : 0;
+			const int inW = (inFormat.layout == QUAT_WXYZ) ? 0 : 3;
+			const int outX = (outFormat.layout == QUAT_WXYZ) ? 1 : 0;
+			const int outW = (outFormat.layout == QUAT_WXYZ) ? 0 : 3;
+
+			for (int n = 0; n < BATCH_COUNT; ++n)
+			{
+				const T *q = in + n * 4;
+				double qx(q[inX]), qy(q[inX + 1]), qz(q[inX + 2]), qw(q[inW]);
+				if (inFormat.convention == QUAT_JPL)
+				{
+					qx = -qx; qy = -qy; qz = -qz;
+				}
+				quatCob( caseNumber, qx, qy, qz, qw );
+				if (outFormat.convention == QUAT_JPL)
+				{
+					qx = -qx; qy = -qy; qz = -qz;
+				}
+
+				EXPECT_EQ( T(qx), out[n * 4 + outX] );
+				EXPECT_EQ( T(qy), out[n * 4 + outX + 1] );
+				EXPECT_EQ( T(qz), out[n * 4 + outX + 2] );
+				EXPECT_EQ( T(qw), out[n * 4 + outW] );
+
+				for (int c = 0; c < 4; ++c)
+				{
+					EXPECT_EQ( out[n * 4 + c], inPlace[n * 4 + c] );
+				}
+			}
+		}
+	}
+}
+
+template <typename T>
+static void checkVectorCobBatch()
+{
+	T in[BATCH_COUNT * 3];
+	T out[BATCH_COUNT * 3];
+	T inPlace[BATCH_COUNT * 3];
+
+	fillValues( in, BATCH_COUNT * 3 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		vectorCobBatch( caseNumber, in, out, BATCH_COUNT );
+
+		for (int i = 0; i < BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		vectorCobBatch( caseNumber, inPlace, BATCH_COUNT );
+
+		for (int n = 0; n < BATCH_COUNT; ++n)
+		{
+			const T *v = in + n * 3;
+			double vx(v[0]), vy(v[1]), vz(v[2]);
+			vectorCob( caseNumber, vx, vy, vz );
+
+			EXPECT_EQ( T(vx), out[n * 3] );
+			EXPECT_EQ( T(vy), out[n * 3 + 1] );
+			EXPECT_EQ( T(vz), out[n * 3 + 2] );
+
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( out[n * 3 + c], inPlace[n * 3 + c] );
+			}
+		}
+	}
+}
+
+template <typename T>
+static void checkPseudoVectorCobBatch()
+{
+	T in[BATCH_COUNT * 3];
+	T out[BATCH_COUNT * 3];
+	T inPlace[BATCH_COUNT * 3];
+
+	fillValues( in, BATCH_COUNT * 3 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		pseudoVectorCobBatch( caseNumber, in, out, BATCH_COUNT );
+
+		for (int i = 0; i < BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		pseudoVectorCobBatch( caseNumber, inPlace, BATCH_COUNT );
+
+		for (int n = 0; n < BATCH_COUNT; ++n)
+		{
+			const T *v = in + n * 3;
+			double vx(v[0]), vy(v[1]), vz(v[2]);
+			pseudoVectorCob( caseNumber, vx, vy, vz );
+
+			EXPECT_EQ( T(vx), out[n * 3] );
+			EXPECT_EQ( T(vy), out[n * 3 + 1] );
+			EXPECT_EQ( T(vz), out[n * 3 + 2] );
+
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( out[n * 3 + c], inPlace[n * 3 + c] );
+			}
+		}
+	}
+}
+
+template <typename T>
+static void checkMatrixCob3x3Batch()
+{
+	T in[BATCH_COUNT * 9];
+	T out[BATCH_COUNT * 9];
+	T inPlace[BATCH_COUNT * 9];
+
+	fillValues( in, BATCH_COUNT * 9 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		matrixCob3x3Batch( caseNumber, in, out, BATCH_COUNT );
+
+		for (int i = 0; i < BATCH_COUNT * 9; ++i) inPlace[i] = in[i];
+		matrixCob3x3Batch( caseNumber, inPlace, BATCH_COUNT );
+
+		for (int n = 0; n < BATCH_COUNT; ++n)
+		{
+			double m[9];
+			for (int c = 0; c < 9; ++c) m[c] = in[n * 9 + c];
+
+			matrixCob3x3( caseNumber,
+				m[0], m[1], m[2],
+				m[3], m[4], m[5],
+				m[6], m[7], m[8] );
+
+			for (int c = 0; c < 9; ++c)
+			{
+				EXPECT_EQ( T(m[c]), out[n * 9 + c] );
+				EXPECT_EQ( out[n * 9 + c], inPlace[n * 9 + c] );
+			}
+		}
+	}
+}
+
+// Every pair of layouts must match the row-major batch with the transposes done by hand
+template <typename T>
+static void checkMatrixLayouts()
+{
+	T rowMajor[BATCH_COUNT * 9];
+	T columnMajor[BATCH_COUNT * 9];
+	T expected[BATCH_COUNT * 9];
+	T out[BATCH_COUNT * 9];
+	T inPlace[BATCH_COUNT * 9];
+
+	fillValues( rowMajor, BATCH_COUNT * 9 );
+	for (int n = 0; n < BATCH_COUNT; ++n)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j) columnMajor[n * 9 + j * 3 + i] = rowMajor[n * 9 + i * 3 + j];
+		}
+	}
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		matrixCob3x3Batch( caseNumber, rowMajor, expected, BATCH_COUNT );
+
+		for (int inLayout = MATRIX_ROW_MAJOR; inLayout <= MATRIX_COLUMN_MAJOR; ++inLayout)
+		{
+			for (int outLayout = MATRIX_ROW_MAJOR; outLayout <= MATRIX_COLUMN_MAJOR; ++outLayout)
+			{
+				const T *in = (inLayout == MATRIX_COLUMN_MAJOR) ? columnMajor : rowMajor;
+				matrixCob3x3Batch( caseNumber, inLayout, outLayout, in, out, BATCH_COUNT );
+
+				for (int k = 0; k < BATCH_COUNT * 9; ++k) inPlace[k] = in[k];
+				matrixCob3x3Batch( caseNumber, inLayout, outLayout, inPlace, BATCH_COUNT );
+
+				for (int n = 0; n < BATCH_COUNT; ++n)
+				{
+					for (int i = 0; i < 3; ++i)
+					{
+						for (int j = 0; j < 3; ++j)
+						{
+							const int k = n * 9 + ((outLayout == MATRIX_COLUMN_MAJOR) ? j * 3 + i : i * 3 + j);
+							EXPECT_EQ( expected[n * 9 + i * 3 + j], out[k] );
+							EXPECT_EQ( expected[n * 9 + i * 3 + j], inPlace[k] );
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+template <typename T>
+static void checkEulerCobBatch()
+{
+	T in[BATCH_COUNT * 3];
+	T out[BATCH_COUNT * 3];
+	T inPlace[BATCH_COUNT * 3];
+
+	fillValues( in, BATCH_COUNT * 3 );
+
+	for (int eulerCaseNumber = 0; eulerCaseNumber < 8; ++eulerCaseNumber)
+	{
+		eulerCobBatch( eulerCaseNumber, in, out, BATCH_COUNT );
+
+		for (int i = 0; i < BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		eulerCobBatch( eulerCaseNumber, inPlace, BATCH_COUNT );
+
+		for (int n = 0; n < BATCH_COUNT; ++n)
+		{
+			const T *e = in + n * 3;
+			double yaw(e[0]), pitch(e[1]), roll(e[2]);
+			eulerCob( eulerCaseNumber, yaw, pitch, roll );
+
+			EXPECT_EQ( T(yaw), out[n * 3] );
+			EXPECT_EQ( T(pitch), out[n * 3 + 1] );
+			EXPECT_EQ( T(roll), out[n * 3 + 2] );
+
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( out[n * 3 + c], inPlace[n * 3 + c] );
+			}
+		}
+	}
+}
+
+// Long enough for blocks with one case number and blocks with many
+static const int MIXED_COUNT = 300;
+
+// Every element must match the batch function with its own case number
+template <typename T>
+static void checkMixedBatch()
+{
+	int cases[MIXED_COUNT];
+	for (int n = 0; n < MIXED_COUNT; ++n)
+	{
+		// A run of one case number, then every case and some invalid ones
+		cases[n] = (n < 140) ? 21 : (n * 37) % 53 - 2;
+	}
+
+	T in[MIXED_COUNT * 9];
+	T out[MIXED_COUNT * 9];
+	T inPlace[MIXED_COUNT * 9];
+	T expected[9];
+	fillValues( in, MIXED_COUNT * 9 );
+
+	vectorCobBatchMixed( cases, in, out, MIXED_COUNT );
+	for (int i = 0; i < MIXED_COUNT * 3; ++i) inPlace[i] = in[i];
+	vectorCobBatchMixed( cases, inPlace, MIXED_COUNT );
+	for (int n = 0; n < MIXED_COUNT; ++n)
+	{
+		vectorCobBatch( cases[n], in + n * 3, expected, 1 );
+		for (int c = 0; c < 3; ++c)
+		{
+			EXPECT_EQ( expected[c], out[n * 3 + c] );
+			EXPECT_EQ( expected[c], inPlace[n * 3 + c] );
+		}
+	}
+
+	for (int layout = QUAT_XYZW; layout <= QUAT_WXYZ; ++layout)
+	{
+		quatCobBatchMixed( cases, layout, in, out, MIXED_COUNT );
+		for (int i = 0; i < MIXED_COUNT * 4; ++i) inPlace[i] = in[i];
+		quatCobBatchMixed( cases, layout, inPlace, MIXED_COUNT );
+		for (int n = 0; n < MIXED_COUNT; ++n)
+		{
+			quatCobBatch( cases[n], layout, in + n * 4, expected, 1 );
+			for (int c = 0; c < 4; ++c)
+			{
+				EXPECT_EQ( expected[c], out[n * 4 + c] );
+				EXPECT_EQ( expected[c], inPlace[n * 4 + c] );
+			}
+		}
+	}
+
+	matrixCob3x3BatchMixed( cases, in, out, MIXED_COUNT );
+	for (int i = 0; i < MIXED_COUNT * 9; ++i) inPlace[i] = in[i];
+	matrixCob3x3BatchMixed( cases, inPlace, MIXED_COUNT );
+	for (int n = 0; n < MIXED_COUNT; ++n)
+	{
+		matrixCob3x3Batch( cases[n], in + n * 9, expected, 1 );
+		for (int c = 0; c < 9; ++c)
+		{
+			EXPECT_EQ( expected[c], out[n * 9 + c] );
+			EXPECT_EQ( expected[c], inPlace[n * 9 + c] );
+		}
+	}
+}
+
+// Structs of STRIDED_SIZE scalars with the field STRIDED_OFFSET scalars in.  More than two
+// blocks of STRIDED_BLOCK.
+static const int STRIDED_COUNT = 150;
+static const int STRIDED_SIZE = 13;
+static const int STRIDED_OFFSET = 3;
+
+// The field of every struct packed together
+template <typename T>
+static void packStridedField( int lanes, const T *structs, T *packed )
+{
+	for (int n = 0; n < STRIDED_COUNT; ++n)
+	{
+		for (int c = 0; c < lanes; ++c) packed[n * lanes + c] = structs[n * STRIDED_SIZE + STRIDED_OFFSET + c];
+	}
+}
+
+// The fields converted into a packed array and in place must match the packed batch
+// function, and the rest of each struct must be untouched
+template <typename T>
+static void checkStridedField( int lanes, const T *in, const T *structs, const T *out, const T *expected )
+{
+	for (int i = 0; i < STRIDED_COUNT * lanes; ++i) EXPECT_EQ( expected[i], out[i] );
+
+	for (int n = 0; n < STRIDED_COUNT; ++n)
+	{
+		for (int c = 0; c < STRIDED_SIZE; ++c)
+		{
+			const int field = c - STRIDED_OFFSET;
+			if (field >= 0 && field < lanes) EXPECT_EQ( expected[n * lanes + field], structs[n * STRIDED_SIZE + c] );
+			else EXPECT_EQ( in[n * STRIDED_SIZE + c], structs[n * STRIDED_SIZE + c] );
+		}
+	}
+}
+
+template <typename T>
+static void checkStridedBatch()
+{
+	T in[STRIDED_COUNT * STRIDED_SIZE];
+	T structs[STRIDED_COUNT * STRIDED_SIZE];
+	T out[STRIDED_COUNT * 9];
+	T expected[STRIDED_COUNT * 9];
+	fillValues( in, STRIDED_COUNT * STRIDED_SIZE );
+
+	const size_t stride = STRIDED_SIZE * sizeof(T);
+	for (int caseNumber = 0; caseNumber < 48; caseNumber += 5)
+	{
+		packStridedField( 3, in, expected );
+		vectorCobBatch( caseNumber, expected, STRIDED_COUNT );
+		vectorCobBatchStrided( caseNumber, in + STRIDED_OFFSET, stride, out, 3 * sizeof(T), STRIDED_COUNT );
+		for (int i = 0; i < STRIDED_COUNT * STRIDED_SIZE; ++i) structs[i] = in[i];
+		vectorCobBatchStrided( caseNumber, structs + STRIDED_OFFSET, stride, STRIDED_COUNT );
+		checkStridedField( 3, in, structs, out, expected );
+
+		for (int layout = QUAT_XYZW; layout <= QUAT_WXYZ; ++layout)
+		{
+			packStridedField( 4, in, expected );
+			quatCobBatch( caseNumber, layout, expected, STRIDED_COUNT );
+			quatCobBatchStrided( caseNumber, layout, in + STRIDED_OFFSET, stride, out, 4 * sizeof(T), STRIDED_COUNT );
+			for (int i = 0; i < STRIDED_COUNT * STRIDED_SIZE; ++i) structs[i] = in[i];
+			quatCobBatchStrided( caseNumber, layout, structs + STRIDED_OFFSET, stride, STRIDED_COUNT );
+			checkStridedField( 4, in, structs, out, expected );
+		}
+
+		packStridedField( 9, in, expected );
+		matrixCob3x3Batch( caseNumber, expected, STRIDED_COUNT );
+		matrixCob3x3BatchStrided( caseNumber, in + STRIDED_OFFSET, stride, out, 9 * sizeof(T), STRIDED_COUNT );
+		for (int i = 0; i < STRIDED_COUNT * STRIDED_SIZE; ++i) structs[i] = in[i];
+		matrixCob3x3BatchStrided( caseNumber, structs + STRIDED_OFFSET, stride, STRIDED_COUNT );
+		checkStridedField( 9, in, structs, out, expected );
+	}
+}
+
+// More than two registers of floats with some left over
+static const int SOA_COUNT = 37;
+
+// Component k of every packed element
+template <typename T>
+static void getComponent( const T *packed, int lanes, int k, T *component )
+{
+	for (int n = 0; n < SOA_COUNT; ++n) component[n] = packed[n * lanes + k];
+}
+
+template <typename T>
+static void checkComponent( const T *expected, int lanes, int k, const T *component )
+{
+	for (int n = 0; n < SOA_COUNT; ++n) EXPECT_EQ( expected[n * lanes + k], component[n] );
+}
+
+// The SoA functions must match the packed batch functions
+template <typename T>
+static void checkSoABatch()
+{
+	T in[SOA_COUNT * 4];
+	T out[SOA_COUNT * 4];
+	T expected[SOA_COUNT * 4];
+	T x[SOA_COUNT], y[SOA_COUNT], z[SOA_COUNT], w[SOA_COUNT];
+	fillValues( in, SOA_COUNT * 4 );
+
+	for (int caseNumber = -1; caseNumber <= 48; ++caseNumber)
+	{
+		vectorCobBatch( caseNumber, in, expected, SOA_COUNT );
+		vectorCobAoSToSoA( caseNumber, in, x, y, z, SOA_COUNT );
+		checkComponent( expected, 3, 0, x );
+		checkComponent( expected, 3, 1, y );
+		checkComponent( expected, 3, 2, z );
+
+		getComponent( in, 3, 0, x );
+		getComponent( in, 3, 1, y );
+		getComponent( in, 3, 2, z );
+		vectorCobSoAToAoS( caseNumber, x, y, z, out, SOA_COUNT );
+		for (int i = 0; i < SOA_COUNT * 3; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		// The same three arrays come back in some order
+		T *px = x, *py = y, *pz = z;
+		vectorCobSoA( caseNumber, px, py, pz, SOA_COUNT );
+		EXPECT_TRUE( px != py && py != pz && pz != px );
+		EXPECT_TRUE( (px == x || px == y || px == z) && (py == x || py == y || py == z) && (pz == x || pz == y || pz == z) );
+		checkComponent( expected, 3, 0, px );
+		checkComponent( expected, 3, 1, py );
+		checkComponent( expected, 3, 2, pz );
+
+		pseudoVectorCobBatch( caseNumber, in, expected, SOA_COUNT );
+		getComponent( in, 3, 0, x );
+		getComponent( in, 3, 1, y );
+		getComponent( in, 3, 2, z );
+		px = x, py = y, pz = z;
+		pseudoVectorCobSoA( caseNumber, px, py, pz, SOA_COUNT );
+		checkComponent( expected, 3, 0, px );
+		checkComponent( expected, 3, 1, py );
+		checkComponent( expected, 3, 2, pz );
+
+		for (int layout = QUAT_XYZW; layout <= QUAT_WXYZ; ++layout)
+		{
+			// The component arrays are always x, y, z, w
+			const int xLane = (layout == QUAT_WXYZ) ? 1 : 0;
+			const int wLane = (layout == QUAT_WXYZ) ? 0 : 3;
+
+			quatCobBatch( caseNumber, layout, in, expected, SOA_COUNT );
+			quatCobAoSToSoA( caseNumber, layout, in, x, y, z, w, SOA_COUNT );
+			checkComponent( expected, 4, xLane, x );
+			checkComponent( expected, 4, xLane + 1, y );
+			checkComponent( expected, 4, xLane + 2, z );
+			checkComponent( expected, 4, wLane, w );
+
+			getComponent( in, 4, xLane, x );
+			getComponent( in, 4, xLane + 1, y );
+			getComponent( in, 4, xLane + 2, z );
+			getComponent( in, 4, wLane, w );
+			quatCobSoAToAoS( caseNumber, layout, x, y, z, w, out, SOA_COUNT );
+			for (int i = 0; i < SOA_COUNT * 4; ++i) EXPECT_EQ( expected[i], out[i] );
+
+			T *qx = x, *qy = y, *qz = z, *qw = w;
+			quatCobSoA( caseNumber, qx, qy, qz, qw, SOA_COUNT );
+			checkComponent( expected, 4, xLane, qx );
+			checkComponent( expected, 4, xLane + 1, qy );
+			checkComponent( expected, 4, xLane + 2, qz );
+			checkComponent( expected, 4, wLane, qw );
+		}
+	}
+}
+
+// Half floats are only bits to the change of basis, so any bits will do as long as
+// the sign bits vary.  The batch versions must match the single element versions.
+static void fillHalfBatch( uint16_t *values, int count )
+{
+	for (int i = 0; i < count; ++i)
+	{
+		values[i] = static_cast<uint16_t>(0x3C00 + i * 0x21 + ((i & 1) ? 0x8000 : 0));
+	}
+}
+
+static void checkHalfBatch()
+{
+	uint16_t in[HALF_BATCH_COUNT * 9];
+	uint16_t out[HALF_BATCH_COUNT * 9];
+	uint16_t inPlace[HALF_BATCH_COUNT * 9];
+	uint16_t e[9];
+
+	fillHalfBatch( in, HALF_BATCH_COUNT * 9 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		vectorCobBatchHalf( caseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		vectorCobBatchHalf( caseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 3; ++c) e[c] = in[n * 3 + c];
+			vectorCobHalf( caseNumber, e[0], e[1], e[2] );
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 3 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 3 + c] );
+			}
+		}
+
+		for (int layout = QUAT_XYZW; layout <= QUAT_WXYZ; ++layout)
+		{
+			const int x = (layout == QUAT_WXYZ) ? 1 : 0;
+			const int w = (layout == QUAT_WXYZ) ? 0 : 3;
+
+			quatCobBatchHalf( caseNumber, layout, in, out, HALF_BATCH_COUNT );
+			for (int i = 0; i < HALF_BATCH_COUNT * 4; ++i) inPlace[i] = in[i];
+			quatCobBatchHalf( caseNumber, layout, inPlace, HALF_BATCH_COUNT );
+			for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+			{
+				for (int c = 0; c < 4; ++c) e[c] = in[n * 4 + c];
+				quatCobHalf( caseNumber, e[x], e[x + 1], e[x + 2], e[w] );
+				for (int c = 0; c < 4; ++c)
+				{
+					EXPECT_EQ( e[c], out[n * 4 + c] );
+					EXPECT_EQ( e[c], inPlace[n * 4 + c] );
+				}
+			}
+		}
+
+		matrixCob3x3BatchHalf( caseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 9; ++i) inPlace[i] = in[i];
+		matrixCob3x3BatchHalf( caseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 9; ++c) e[c] = in[n * 9 + c];
+			matrixCob3x3Half( caseNumber, e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7], e[8] );
+			for (int c = 0; c < 9; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 9 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 9 + c] );
+			}
+		}
+	}
+
+	for (int eulerCaseNumber = 0; eulerCaseNumber < 8; ++eulerCaseNumber)
+	{
+		eulerCobBatchHalf( eulerCaseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		eulerCobBatchHalf( eulerCaseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 3; ++c) e[c] = in[n * 3 + c];
+			eulerCobHalf( eulerCaseNumber, e[0], e[1], e[2] );
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 3 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 3 + c] );
+			}
+		}
+	}
+}
+
+// Raw sensor counts, including the values that saturate.  The batch versions must match
+// the inline single element versions.
+template <typename T>
+static void fillIntegerBatch( T *values, int count )
+{
+	const T special[4] = { std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), 0, -1 };
+	for (int i = 0; i < count; ++i)
+	{
+		values[i] = (i % 5 == 4) ? special[(i / 5) % 4] : static_cast<T>((i + 1) * 1237 * ((i & 1) ? -1 : 1));
+	}
+}
+
+template <typename T>
+static void checkIntegerBatch()
+{
+	T in[HALF_BATCH_COUNT * 9];
+	T out[HALF_BATCH_COUNT * 9];
+	T inPlace[HALF_BATCH_COUNT * 9];
+	T e[9];
+
+	fillIntegerBatch( in, HALF_BATCH_COUNT * 9 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		vectorCobBatch( caseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		vectorCobBatch( caseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 3; ++c) e[c] = in[n * 3 + c];
+			inlined::vectorCob( caseNumber, e[0], e[1], e[2] );
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 3 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 3 + c] );
+			}
+		}
+
+		pseudoVectorCobBatch( caseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		pseudoVectorCobBatch( caseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 3; ++c) e[c] = in[n * 3 + c];
+			inlined::pseudoVectorCob( caseNumber, e[0], e[1], e[2] );
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 3 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 3 + c] );
+			}
+		}
+
+		for (int layout = QUAT_XYZW; layout <= QUAT_WXYZ; ++layout)
+		{
+			const int x = (layout == QUAT_WXYZ) ? 1 : 0;
+			const int w = (layout == QUAT_WXYZ) ? 0 : 3;
+
+			quatCobBatch( caseNumber, layout, in, out, HALF_BATCH_COUNT );
+			for (int i = 0; i < HALF_BATCH_COUNT * 4; ++i) inPlace[i] = in[i];
+			quatCobBatch( caseNumber, layout, inPlace, HALF_BATCH_COUNT );
+			for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+			{
+				for (int c = 0; c < 4; ++c) e[c] = in[n * 4 + c];
+				inlined::quatCob( caseNumber, e[x], e[x + 1], e[x + 2], e[w] );
+				for (int c = 0; c < 4; ++c)
+				{
+					EXPECT_EQ( e[c], out[n * 4 + c] );
+					EXPECT_EQ( e[c], inPlace[n * 4 + c] );
+				}
+			}
+		}
+
+		matrixCob3x3Batch( caseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 9; ++i) inPlace[i] = in[i];
+		matrixCob3x3Batch( caseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 9; ++c) e[c] = in[n * 9 + c];
+			inlined::matrixCob3x3( caseNumber, e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7], e[8] );
+			for (int c = 0; c < 9; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 9 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 9 + c] );
+			}
+		}
+	}
+
+	for (int eulerCaseNumber = 0; eulerCaseNumber < 8; ++eulerCaseNumber)
+	{
+		eulerCobBatch( eulerCaseNumber, in, out, HALF_BATCH_COUNT );
+		for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i) inPlace[i] = in[i];
+		eulerCobBatch( eulerCaseNumber, inPlace, HALF_BATCH_COUNT );
+		for (int n = 0; n < HALF_BATCH_COUNT; ++n)
+		{
+			for (int c = 0; c < 3; ++c) e[c] = in[n * 3 + c];
+			inlined::eulerCob( eulerCaseNumber, e[0], e[1], e[2] );
+			for (int c = 0; c < 3; ++c)
+			{
+				EXPECT_EQ( e[c], out[n * 3 + c] );
+				EXPECT_EQ( e[c], inPlace[n * 3 + c] );
+			}
+		}
+	}
+}
+
+// Every lane of every element changes sign, so each special value lands in a SIMD lane.
+template <typename T>
+static void checkIntegerSaturates()
+{
+	const T lowest = std::numeric_limits<T>::min();
+	const T highest = std::numeric_limits<T>::max();
+
+	T v[HALF_BATCH_COUNT * 3];
+	for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i)
+	{
+		v[i] = (i & 1) ? lowest : highest;
+	}
+
+	eulerCobBatch( 7, v, HALF_BATCH_COUNT );
+
+	for (int i = 0; i < HALF_BATCH_COUNT * 3; ++i)
+	{
+		EXPECT_EQ( (i & 1) ? highest : static_cast<T>(-highest), v[i] );
+	}
+}
+
+// In place batches are converted a block at a time through a buffer, so they must match out
+// of place over many blocks and a partial one at the end
+static const int IN_PLACE_COUNT = 701;
+
+template <typename T>
+static void checkInPlaceBlocks()
+{
+	detail::LanePermutation p[3];
+	detail::getVectorPermutation( 29, p[0] );
+	detail::getMatrixPermutation( 29, p[1] );
+	detail::getMatrix3x4Permutation( 29, MATRIX_ROW_MAJOR, p[2] );
+
+	std::vector<T> in( IN_PLACE_COUNT * 12 );
+	std::vector<T> out( in.size() );
+	fillValues( &in[0], in.size() );
+
+	for (int i = 0; i < 3; ++i)
+	{
+		std::vector<T> inPlace( in );
+		detail::permuteBatch( p[i], &in[0], &out[0], IN_PLACE_COUNT );
+		detail::permuteBatch( p[i], &inPlace[0], &inPlace[0], IN_PLACE_COUNT );
+		EXPECT_TRUE( std::equal( out.begin(), out.begin() + IN_PLACE_COUNT * p[i].lanes, inPlace.begin() ) );
+	}
+}
+
+// A change of sign only flips the sign bit, even of a signaling NaN, so every SIMD level and
+// the single element functions give the same bits
+static void checkNaNSign()
+{
+	const uint64_t nan = 0x7ff4000000000000ULL;
+	const uint64_t sign = 0x8000000000000000ULL;
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		double ones[3] = { 1.0, 1.0, 1.0 };
+		vectorCob( caseNumber, ones[0], ones[1], ones[2] );
+
+		double v[BATCH_COUNT * 3];
+		for (int i = 0; i < BATCH_COUNT * 3; ++i) memcpy( &v[i], &nan, sizeof(nan) );
+		double single[3] = { v[0], v[1], v[2] };
+
+		vectorCobBatch( caseNumber, v, BATCH_COUNT );
+		vectorCob( caseNumber, single[0], single[1], single[2] );
+
+		for (int i = 0; i < BATCH_COUNT * 3; ++i)
+		{
+			const uint64_t expected = (ones[i % 3] < 0.0) ? (nan | sign) : nan;
+			uint64_t bits;
+			memcpy( &bits, &v[i], sizeof(bits) );
+			EXPECT_EQ( expected, bits );
+			memcpy( &bits, &single[i % 3], sizeof(bits) );
+			EXPECT_EQ( expected, bits );
+		}
+
+		// Matrix elements change sign when exactly one of their row and column does
+		double m[9];
+		for (int i = 0; i < 9; ++i) memcpy( &m[i], &nan, sizeof(nan) );
+		double batch[9];
+		memcpy( batch, m, sizeof(m) );
+		matrixCob3x3Batch( caseNumber, batch, 1 );
+		matrixCob3x3( caseNumber, m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8] );
+		EXPECT_EQ( 0, memcmp( batch, m, sizeof(m) ) );
+	}
+}
+
+void forEachSimdLevel( void (*check)() )
+{
+	const int original = getSimdLevel();
+
+	for (int level = SIMD_NONE; level <= original; ++level)
+	{
+		EXPECT_EQ( level, setSimdLevel( level ) );
+		check();
+	}
+
+	setSimdLevel( original );
+}
+
+TEST(BatchChecks, QuatCobBatch)
+{
+	forEachSimdLevel( checkQuatCobBatch<double> );
+	forEachSimdLevel( checkQuatCobBatch<float> );
+}
+
+TEST(BatchChecks, QuatFormats)
+{
+	forEachSimdLevel( checkQuatFormats<double> );
+	forEachSimdLevel( checkQuatFormats<float> );
+}
+
+TEST(BatchChecks, VectorCobBatch)
+{
+	forEachSimdLevel( checkVectorCobBatch<double> );
+	forEachSimdLevel( checkVectorCobBatch<float> );
+}
+
+TEST(BatchChecks, PseudoVectorCobBatch)
+{
+	forEachSimdLevel( checkPseudoVectorCobBatch<double> );
+	forEachSimdLevel( checkPseudoVectorCobBatch<float> );
+}
+
+TEST(BatchChecks, MatrixCob3x3Batch)
+{
+	forEachSimdLevel( checkMatrixCob3x3Batch<double> );
+	forEachSimdLevel( checkMatrixCob3x3Batch<float> );
+}
+
+TEST(BatchChecks, MatrixLayouts)
+{
+	forEachSimdLevel( checkMatrixLayouts<double> );
+	forEachSimdLevel( checkMatrixLayouts<float> );
+}
+
+TEST(BatchChecks, EulerCobBatch)
+{
+	forEachSimdLevel( checkEulerCobBatch<double> );
+	forEachSimdLevel( checkEulerCobBatch<float> );
+}
+
+TEST(BatchChecks, MixedBatch)
+{
+	forEachSimdLevel( checkMixedBatch<double> );
+	forEachSimdLevel( checkMixedBatch<float> );
+}
+
+TEST(BatchChecks, StridedBatch)
+{
+	forEachSimdLevel( checkStridedBatch<double> );
+	forEachSimdLevel( checkStridedBatch<float> );
+}
+
+TEST(BatchChecks, SoABatch)
+{
+	forEachSimdLevel( checkSoABatch<double> );
+	forEachSimdLevel( checkSoABatch<float> );
+}
+
+TEST(BatchChecks, HalfBatch)
+{
+	forEachSimdLevel( checkHalfBatch );
+}
+
+TEST(BatchChecks, IntegerBatch)
+{
+	forEachSimdLevel( checkIntegerBatch<int16_t> );
+	forEachSimdLevel( checkIntegerBatch<int32_t> );
+	forEachSimdLevel( checkIntegerSaturates<int16_t> );
+	forEachSimdLevel( checkIntegerSaturates<int32_t> );
+}
+
+TEST(BatchChecks, InPlaceBlocks)
+{
+	forEachSimdLevel( checkInPlaceBlocks<double> );
+	forEachSimdLevel( checkInPlaceBlocks<float> );
+	forEachSimdLevel( checkInPlaceBlocks<int16_t> );
+	forEachSimdLevel( checkInPlaceBlocks<int32_t> );
+}
+
+TEST(BatchChecks, NaNSign)
+{
+	forEachSimdLevel( checkNaNSign );
+}
+
+TEST(BatchChecks, SimdLevelIsClamped)
+{
+	const int original = getSimdLevel();
+
+	EXPECT_EQ( original, setSimdLevel( SIMD_AVX512 + 1 ) );
+	EXPECT_EQ( SIMD_NONE, setSimdLevel( -1 ) );
+
+	setSimdLevel( original );
+}
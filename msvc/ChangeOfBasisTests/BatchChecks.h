@@ -0,0 +1,38 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#pragma once
+
+#ifndef BATCH_CHECKS_H
+#define BATCH_CHECKS_H
+
+#include <stddef.h>
+
+// Helpers shared by the batch tests
+
+// Distinct values of both signs that every scalar type the tests use holds exactly, so
+// converted arrays can be compared exactly
+template <typename T>
+void fillValues( T *values, size_t count )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		values[i] = T(((i % 1013) + 1) * ((i % 3) ? -1 : 1));
+	}
+}
+
+// Runs a check once for every SIMD level this CPU supports.  Defined in BatchChecks.cpp.
+void forEachSimdLevel( void (*check)() );
+
+#endif // BATCH_CHECKS_H
@@ -82,5 +82,28 @@ namespace cob
 			std::cout << qB << std::endl;
 		}
 		EXPECT_TRUE( match );
+
+		// The cross product of two vectors is a pseudovector
+		Vector3d a( 1.0, 2.0, 3.0 );
+		Vector3d b( -4.0, 5.0, 0.5 );
+		Vector3d c = cross( a, b );
+
+		vectorCob( caseNumber, a._x, a._y, a._z );
+		vectorCob( caseNumber, b._x, b._y, b._z );
+		Vector3d cAnswer = cross( a, b );
+
+		pseudoVectorCob( caseNumber, c._x, c._y, c._z );
+
+		match = cAnswer.equals( c, 0.001 );
+		if (!match)
+		{
+			std::cout << "Test failed ----" << std::endl;
+			std::cout << "Correct ----" << std::endl;
+			std::cout << cAnswer << std::endl;
+
+			std::cout << "Wrong " << std::endl;
+			std::cout << c << std::endl;
+		}
+		EXPECT_TRUE( match );
 	}
 }
\ No newline at end of file
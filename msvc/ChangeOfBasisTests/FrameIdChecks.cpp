@@ -0,0 +1,93 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisInline.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+const triple getFrame( int index );		// FullChecks.cpp
+
+static_assert( inlined::getCaseNumber( inlined::getFrameId( KinectFrame ), inlined::getFrameId( OpenGLFrame ) ) == 5, "the frame pair table is built at compile time" );
+static_assert( inlined::getEulerCaseNumber( KinectFrame, OpenGLFrame ) == 3, "Euler case number is computed at compile time" );
+static_assert( inlined::getFrameId( triple( 100, RIGHT, UP ) ) == FRAME_COUNT, "invalid triples have no frame id" );
+static_assert( inlined::getFrameFromId( FRAME_COUNT ).a == -1, "ids past the last frame give a triple that isn't a frame" );
+
+TEST(FrameIdChecks, RoundTrip)
+{
+	bool used[FRAME_COUNT] = {};
+
+	for (int i = 0; i < FRAME_COUNT; ++i)
+	{
+		const FrameId id = getFrameId( getFrame(i) );
+		ASSERT_LT( id, FRAME_COUNT );
+		EXPECT_FALSE( used[id] );
+		used[id] = true;
+
+		const triple frame = getFrameFromId( id );
+		EXPECT_EQ( getFrame(i).a, frame.a );
+		EXPECT_EQ( getFrame(i).b, frame.b );
+		EXPECT_EQ( getFrame(i).c, frame.c );
+	}
+}
+
+// The tables must match the functions that work the case numbers out from the frames.
+TEST(FrameIdChecks, EveryPair)
+{
+	for (int i = 0; i < FRAME_COUNT; ++i)
+	{
+		for (int j = 0; j < FRAME_COUNT; ++j)
+		{
+			const FrameId from = getFrameId( getFrame(i) );
+			const FrameId to = getFrameId( getFrame(j) );
+			EXPECT_EQ( getCaseNumber( getFrame(i), getFrame(j) ), getCaseNumber( from, to ) );
+			EXPECT_EQ( getEulerCaseNumber( getFrame(i), getFrame(j) ), getEulerCaseNumber( from, to ) );
+		}
+	}
+}
+
+// Triples that aren't frames get FRAME_COUNT and never reach the tables
+TEST(FrameIdChecks, Invalid)
+{
+	const triple invalid[] =
+	{
+		triple( 100, RIGHT, UP ),
+		triple( FORWARD, RIGHT, -1 ),
+		triple( FORWARD, 3, UP ),
+		triple( FORWARD, 7, UP ),
+		triple( FORWARD, BACK, UP ),
+		triple( LEFT, RIGHT, DOWN ),
+		triple( UP, UP, UP )
+	};
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+	{
+		EXPECT_EQ( FRAME_COUNT, getFrameId( invalid[i] ) );
+		EXPECT_EQ( 0, getEulerCaseNumber( invalid[i], KinectFrame ) );
+		EXPECT_EQ( 0, getEulerCaseNumber( OpenGLFrame, invalid[i] ) );
+
+		// And the id of a triple that isn't a frame doesn't lead back into the tables
+		const triple back = getFrameFromId( getFrameId( invalid[i] ) );
+		EXPECT_EQ( -1, back.a );
+		EXPECT_EQ( -1, back.b );
+		EXPECT_EQ( -1, back.c );
+	}
+
+	for (int id = FRAME_COUNT; id < 256; ++id)
+	{
+		EXPECT_EQ( FRAME_COUNT, getFrameId( getFrameFromId( static_cast<FrameId>(id) ) ) );
+	}
+}
@@ -0,0 +1,82 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisInline.h"
+#include "Math.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+const triple getFrame( int index );		// FullChecks.cpp
+
+static_assert( inlined::composeCase( 5, inlined::inverseCase( 5 ) ) == 0, "the group tables are built at compile time" );
+
+static ColumnMatrix3d getAtoB( int caseNumber )
+{
+	ColumnMatrix3d m;
+	getAtoBMatrix( caseNumber,
+		m._m[0][0], m._m[0][1], m._m[0][2],
+		m._m[1][0], m._m[1][1], m._m[1][2],
+		m._m[2][0], m._m[2][1], m._m[2][2] );
+	return m;
+}
+
+// The tables must agree with multiplying the MAtoB matrices.
+TEST(GroupChecks, ComposeMatchesMatrices)
+{
+	for (int AtoB = 0; AtoB < 48; ++AtoB)
+	{
+		for (int BtoC = 0; BtoC < 48; ++BtoC)
+		{
+			const ColumnMatrix3d AtoC = getAtoB( BtoC ) * getAtoB( AtoB );
+			EXPECT_TRUE( AtoC.equals( getAtoB( composeCase( AtoB, BtoC ) ) ) );
+		}
+	}
+}
+
+TEST(GroupChecks, Inverse)
+{
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		const int inverse = inverseCase( caseNumber );
+		EXPECT_TRUE( isIdentity( composeCase( caseNumber, inverse ) ) );
+		EXPECT_TRUE( isIdentity( composeCase( inverse, caseNumber ) ) );
+		EXPECT_TRUE( getAtoB( caseNumber ).transpose().equals( getAtoB( inverse ) ) );
+		EXPECT_EQ( isReflection( caseNumber ), getAtoB( caseNumber ).determinant() < 0.0 );
+	}
+}
+
+// A chain of frames collapses to the case number between the ends.
+TEST(GroupChecks, ChainOfFrames)
+{
+	const triple sensor( RIGHT, FORWARD, UP );
+
+	const int chain = composeCase( composeCase(
+		getCaseNumber( sensor, PrioVRFrame ),
+		getCaseNumber( PrioVRFrame, OpenGLFrame ) ),
+		getCaseNumber( OpenGLFrame, Unreal3Frame ) );
+
+	EXPECT_EQ( getCaseNumber( sensor, Unreal3Frame ), chain );
+	EXPECT_TRUE( isIdentity( composeCase( getCaseNumber( KinectFrame, Unreal3Frame ), getCaseNumber( Unreal3Frame, KinectFrame ) ) ) );
+
+	for (int i = 0; i < 48; ++i)
+	{
+		for (int j = 0; j < 48; ++j)
+		{
+			EXPECT_EQ( getCaseNumber( getFrame(j), getFrame(i) ), inverseCase( getCaseNumber( getFrame(i), getFrame(j) ) ) );
+		}
+	}
+}
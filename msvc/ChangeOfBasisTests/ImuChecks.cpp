@@ -0,0 +1,146 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasis.h"
+#include "changeOfBasisInline.h"
+#include "BatchChecks.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+// imuCobBatch must give exactly the same answer as converting each field on its own.
+
+static const int IMU_COUNT = 9;
+
+// A sample with a timestamp first and the quaternion w first, like a typical sensor packet
+static const ImuLayout StampedLayout = { 14, 1, 4, 11, 7, QUAT_WXYZ };
+
+// Converts each field of each sample with the batch functions for that field
+template <typename T>
+static void convertFields( int caseNumber, const ImuLayout &layout, T *samples, int count )
+{
+	for (int n = 0; n < count; ++n)
+	{
+		T *s = samples + n * layout.stride;
+		vectorCobBatch( caseNumber, s + layout.accel, 1 );
+		pseudoVectorCobBatch( caseNumber, s + layout.gyro, 1 );
+		pseudoVectorCobBatch( caseNumber, s + layout.mag, 1 );
+		quatCobBatch( caseNumber, layout.quatLayout, s + layout.quat, 1 );
+	}
+}
+
+template <typename T>
+static void checkLayout( const ImuLayout &layout )
+{
+	T in[IMU_COUNT * IMU_MAX_STRIDE];
+	T out[IMU_COUNT * IMU_MAX_STRIDE];
+	T inPlace[IMU_COUNT * IMU_MAX_STRIDE];
+	T expected[IMU_COUNT * IMU_MAX_STRIDE];
+
+	const int total = IMU_COUNT * layout.stride;
+	fillValues( in, total );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		ImuCob cob;
+		EXPECT_TRUE( getImuCob( caseNumber, layout, cob ) );
+
+		imuCobBatch( cob, in, out, IMU_COUNT );
+
+		for (int i = 0; i < total; ++i) inPlace[i] = expected[i] = in[i];
+		imuCobBatch( cob, inPlace, IMU_COUNT );
+		convertFields( caseNumber, layout, expected, IMU_COUNT );
+
+		for (int i = 0; i < total; ++i)
+		{
+			EXPECT_EQ( expected[i], out[i] );
+			EXPECT_EQ( expected[i], inPlace[i] );
+		}
+	}
+}
+
+template <typename T>
+static void checkImuCobBatch()
+{
+	checkLayout<T>( ImuPackedLayout );
+	checkLayout<T>( StampedLayout );
+}
+
+TEST(ImuChecks, ImuCobBatch)
+{
+	forEachSimdLevel( checkImuCobBatch<double> );
+	forEachSimdLevel( checkImuCobBatch<float> );
+	forEachSimdLevel( checkImuCobBatch<int16_t> );
+	forEachSimdLevel( checkImuCobBatch<int32_t> );
+}
+
+// The frame pair version matches the case number version
+TEST(ImuChecks, FramePair)
+{
+	ImuCob a, b;
+	EXPECT_TRUE( getImuCob( PrioVRFrame, Unreal3Frame, ImuPackedLayout, a ) );
+	EXPECT_TRUE( getImuCob( getCaseNumber( PrioVRFrame, Unreal3Frame ), ImuPackedLayout, b ) );
+
+	EXPECT_EQ( b.stride, a.stride );
+	for (int k = 0; k < IMU_MAX_STRIDE; ++k)
+	{
+		EXPECT_EQ( b.index[k], a.index[k] );
+		EXPECT_EQ( b.negate[k], a.negate[k] );
+	}
+}
+
+// A layout that doesn't fit copies the samples unchanged
+TEST(ImuChecks, BadLayout)
+{
+	const ImuLayout overlapping = { 13, 0, 2, 6, 9, QUAT_XYZW };
+	const ImuLayout tooShort = { 12, 0, 3, 6, 9, QUAT_XYZW };
+	const ImuLayout tooLong = { IMU_MAX_STRIDE + 1, 0, 3, 6, 9, QUAT_XYZW };
+
+	ImuCob cob;
+	EXPECT_FALSE( getImuCob( 5, overlapping, cob ) );
+	EXPECT_EQ( 13, cob.stride );
+
+	float in[13 * 3];
+	float out[13 * 3];
+	fillValues( in, 13 * 3 );
+	imuCobBatch( cob, in, out, 3 );
+	for (int i = 0; i < 13 * 3; ++i)
+	{
+		EXPECT_EQ( in[i], out[i] );
+	}
+
+	EXPECT_FALSE( getImuCob( 5, tooShort, cob ) );
+	EXPECT_FALSE( getImuCob( 5, tooLong, cob ) );
+}
+
+// Fields the sample doesn't have are left alone
+TEST(ImuChecks, MissingFields)
+{
+	const ImuLayout accelOnly = { 3, 0, -1, -1, -1, QUAT_XYZW };
+
+	ImuCob cob;
+	EXPECT_TRUE( getImuCob( 5, accelOnly, cob ) );
+
+	double v[3 * 5];
+	double expected[3 * 5];
+	fillValues( v, 3 * 5 );
+	vectorCobBatch( 5, v, expected, 5 );
+	imuCobBatch( cob, v, 5 );
+	for (int i = 0; i < 3 * 5; ++i)
+	{
+		EXPECT_EQ( expected[i], v[i] );
+	}
+}
@@ -0,0 +1,83 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisInline.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+const triple getFrame( int index );		// FullChecks.cpp
+
+// The value returning functions can be evaluated by the compiler
+static_assert( inlined::getCaseNumber( KinectFrame, OpenGLFrame ) == 5, "case number is computed at compile time" );
+static_assert( inlined::vectorCob( 5, Vector3<double>{ 1.0, 2.0, 3.0 } ).z == -3.0, "vectorCob is constexpr" );
+static_assert( inlined::quatCob( 1, Quaternion<double>{ 1.0, 2.0, 3.0, 4.0 } ).x == -1.0, "quatCob is constexpr" );
+static_assert( inlined::matrixCob3x3( 1, Matrix3x3<double>{ { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } } } ).m[0][2] == -3.0, "matrixCob3x3 is constexpr" );
+
+// The inline functions must match the out of line ones for every pair of frames.
+TEST(InlineChecks, EveryPair)
+{
+	for (int i = 0; i < 48; ++i)
+	{
+		for (int j = 0; j < 48; ++j)
+		{
+			const int caseNumber = getCaseNumber( getFrame(i), getFrame(j) );
+			EXPECT_EQ( caseNumber, inlined::getCaseNumber( getFrame(i), getFrame(j) ) );
+
+			double vx(1.5), vy(-2.5), vz(3.5);
+			vectorCob( caseNumber, vx, vy, vz );
+			const Vector3<float> v = inlined::vectorCob( caseNumber, Vector3<float>{ 1.5f, -2.5f, 3.5f } );
+			EXPECT_EQ( float(vx), v.x );
+			EXPECT_EQ( float(vy), v.y );
+			EXPECT_EQ( float(vz), v.z );
+
+			double qx(0.1), qy(-0.2), qz(0.3), qw(0.9);
+			double sx(qx), sy(qy), sz(qz), sw(qw);
+			quatCob( caseNumber, qx, qy, qz, qw );
+			const Quaternion<double> q = inlined::quatCob( caseNumber, Quaternion<double>{ sx, sy, sz, sw } );
+			EXPECT_EQ( qx, q.x );
+			EXPECT_EQ( qy, q.y );
+			EXPECT_EQ( qz, q.z );
+			EXPECT_EQ( qw, q.w );
+
+			double r[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+			matrixCob3x3( caseNumber, r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8] );
+			const Matrix3x3<double> m = inlined::matrixCob3x3( caseNumber, Matrix3x3<double>{ { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } } } );
+			for (int k = 0; k < 9; ++k)
+			{
+				EXPECT_EQ( r[k], m.m[k / 3][k % 3] );
+			}
+
+			const int eulerCaseNumber = getEulerCaseNumber( getFrame(i), getFrame(j) );
+			double yaw(10.0), pitch(20.0), roll(30.0);
+			eulerCob( getFrame(i), getFrame(j), yaw, pitch, roll );
+			const EulerAngles<double> e = inlined::eulerCob( eulerCaseNumber, EulerAngles<double>{ 10.0, 20.0, 30.0 } );
+			EXPECT_EQ( yaw, e.yaw );
+			EXPECT_EQ( pitch, e.pitch );
+			EXPECT_EQ( roll, e.roll );
+		}
+	}
+}
+
+TEST(InlineChecks, InvalidCaseDoesNothing)
+{
+	float x(1.0f), y(2.0f), z(3.0f);
+	inlined::vectorCob( 48, x, y, z );
+	inlined::vectorCob( -1, x, y, z );
+	EXPECT_EQ( 1.0f, x );
+	EXPECT_EQ( 2.0f, y );
+	EXPECT_EQ( 3.0f, z );
+}
@@ -0,0 +1,175 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisLazy.h"
+#include "BatchChecks.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+#include <algorithm>
+#include <vector>
+
+using namespace cob;
+
+static const size_t LAZY_COUNT = 257;
+
+// A chain of frames read lazily and then materialized must match converting the data at each step
+template <typename T>
+static void checkChain()
+{
+	const FrameId frames[] = { 5, 46, 17, 17, 30, 0 };
+	const size_t steps = sizeof(frames) / sizeof(frames[0]);
+
+	std::vector<T> data( LAZY_COUNT * 4 );
+	fillValues( &data[0], data.size() );
+	std::vector<T> expected( data );
+	std::vector<T> quats( data );
+
+	LazyArray<T> vectors( &data[0], LAZY_COUNT, ELEMENT_VECTOR, 0, frames[0] );
+	LazyArray<T> lazyQuats( &quats[0], LAZY_COUNT, ELEMENT_QUAT, QUAT_XYZW, frames[0] );
+	ASSERT_TRUE( vectors.isValid() );
+	EXPECT_EQ( 3, vectors.getLanes() );
+	EXPECT_EQ( 4, lazyQuats.getLanes() );
+
+	std::vector<T> expectedQuats( quats );
+	for (size_t s = 1; s < steps; ++s)
+	{
+		const int caseNumber = getCaseNumber( frames[s - 1], frames[s] );
+		vectorCobBatch( caseNumber, &expected[0], LAZY_COUNT );
+		quatCobBatch( caseNumber, QUAT_XYZW, &expectedQuats[0], LAZY_COUNT );
+
+		// Alternate between the two ways of moving the frame
+		if (s % 2) vectors.retarget( frames[s] );
+		else vectors.convert( caseNumber );
+		lazyQuats.convert( caseNumber );
+		EXPECT_EQ( frames[s], vectors.getFrame() );
+		EXPECT_EQ( frames[0], vectors.getStoredFrame() );
+	}
+	EXPECT_EQ( getCaseNumber( frames[0], frames[steps - 1] ), vectors.getPendingCase() );
+
+	// Reads convert on the fly
+	T out[detail::MAX_LANES];
+	for (size_t n = 0; n < LAZY_COUNT; n += 16)
+	{
+		vectors.get( n, out );
+		EXPECT_TRUE( std::equal( out, out + 3, &expected[n * 3] ) );
+	}
+
+	size_t n = 0;
+	for (typename LazyArray<T>::const_iterator it = lazyQuats.begin(); it != lazyQuats.end(); ++it, ++n)
+	{
+		for (int k = 0; k < 4; ++k) EXPECT_EQ( expectedQuats[n * 4 + k], (*it)[k] );
+	}
+	EXPECT_EQ( LAZY_COUNT, n );
+
+	vectors.materialize();
+	lazyQuats.materialize();
+	EXPECT_TRUE( std::equal( expected.begin(), expected.begin() + LAZY_COUNT * 3, data.begin() ) );
+	EXPECT_TRUE( std::equal( expectedQuats.begin(), expectedQuats.end(), quats.begin() ) );
+	EXPECT_EQ( frames[steps - 1], vectors.getStoredFrame() );
+	EXPECT_TRUE( isIdentity( vectors.getPendingCase() ) );
+}
+
+TEST(LazyChecks, Chain)
+{
+	checkChain<double>();
+	checkChain<float>();
+	checkChain<int16_t>();
+	checkChain<int32_t>();
+}
+
+// Moving the frame around must not touch memory until materialize()
+TEST(LazyChecks, NoTouch)
+{
+	std::vector<float> data( LAZY_COUNT * 9 );
+	fillValues( &data[0], data.size() );
+	const std::vector<float> original( data );
+
+	LazyArray<float> m( &data[0], LAZY_COUNT, ELEMENT_MATRIX3X3, 0, 12 );
+	float out[9];
+	for (int id = 0; id < FRAME_COUNT; ++id)
+	{
+		m.retarget( static_cast<FrameId>(id) );
+		m.convert( id );
+		m.get( LAZY_COUNT - 1, out );
+	}
+	EXPECT_TRUE( data == original );
+
+	// Back where it started, so materialize() has nothing to do
+	m.retarget( 12 );
+	EXPECT_TRUE( isIdentity( m.getPendingCase() ) );
+	m.materialize();
+	EXPECT_TRUE( data == original );
+
+	m.retarget( 40 );
+	std::vector<float> expected( original );
+	matrixCob3x3Batch( getCaseNumber( 12, 40 ), &expected[0], LAZY_COUNT );
+	m.materialize();
+	EXPECT_TRUE( data == expected );
+}
+
+// Every case number from every frame must land on the frame getCaseNumber() agrees with
+TEST(LazyChecks, FrameAfterCase)
+{
+	float v[3] = { 1.0f, 2.0f, 3.0f };
+	for (int from = 0; from < FRAME_COUNT; ++from)
+	{
+		for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+		{
+			LazyArray<float> a( v, 1, ELEMENT_VECTOR, 0, static_cast<FrameId>(from) );
+			a.convert( caseNumber );
+			EXPECT_EQ( caseNumber, getCaseNumber( static_cast<FrameId>(from), a.getFrame() ) );
+		}
+	}
+}
+
+// Euler angles use Euler case numbers from the frames, even when the chain is built from case numbers
+TEST(LazyChecks, Euler)
+{
+	std::vector<double> data( LAZY_COUNT * 3 );
+	fillValues( &data[0], data.size() );
+	std::vector<double> expected( data );
+
+	LazyArray<double> angles( &data[0], LAZY_COUNT, ELEMENT_EULER, 0, 3 );
+	angles.convert( getCaseNumber( 3, 20 ) );
+	angles.convert( getCaseNumber( 20, 44 ) );
+	EXPECT_EQ( 44, angles.getFrame() );
+
+	eulerCobBatch( getEulerCaseNumber( 3, 44 ), &expected[0], LAZY_COUNT );
+	angles.materialize();
+	EXPECT_TRUE( data == expected );
+}
+
+TEST(LazyChecks, Invalid)
+{
+	float v[3] = { 1.0f, 2.0f, 3.0f };
+	EXPECT_FALSE( LazyArray<float>( v, 1, ELEMENT_COUNT, 0, 0 ).isValid() );
+	EXPECT_FALSE( LazyArray<float>( v, 1, ELEMENT_VECTOR, 0, FRAME_COUNT ).isValid() );
+	EXPECT_FALSE( LazyArray<float>( NULL, 1, ELEMENT_VECTOR, 0, 0 ).isValid() );
+
+	LazyArray<float> bad( v, 1, ELEMENT_QUAT, 99, 0 );
+	EXPECT_FALSE( bad.isValid() );
+	EXPECT_EQ( 0u, bad.size() );
+	EXPECT_TRUE( bad.begin() == bad.end() );
+	bad.retarget( 7 );
+	bad.materialize();
+	EXPECT_EQ( 1.0f, v[0] );
+
+	// Invalid case numbers are ignored
+	LazyArray<float> good( v, 1, ELEMENT_VECTOR, 0, 0 );
+	good.convert( 48 );
+	good.convert( -1 );
+	EXPECT_EQ( 0, good.getFrame() );
+}
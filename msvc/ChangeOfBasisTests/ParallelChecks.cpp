@@ -0,0 +1,203 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisParallel.h"
+#include "BatchChecks.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+#include <algorithm>
+#include <vector>
+
+using namespace cob;
+
+// Big enough to be split into many tasks
+static const size_t PARALLEL_COUNT = 200001;
+
+// The parallel results must match the serial batch functions exactly
+template <typename T>
+static void checkParallel( int caseNumber )
+{
+	std::vector<T> in( PARALLEL_COUNT * 9 );
+	std::vector<T> out( PARALLEL_COUNT * 9 );
+	std::vector<T> expected( PARALLEL_COUNT * 9 );
+	fillValues( &in[0], in.size() );
+
+	vectorCobBatch( caseNumber, &in[0], &expected[0], PARALLEL_COUNT );
+	vectorCobBatchParallel( caseNumber, &in[0], &out[0], PARALLEL_COUNT );
+	EXPECT_TRUE( std::equal( expected.begin(), expected.begin() + PARALLEL_COUNT * 3, out.begin() ) );
+
+	quatCobBatch( caseNumber, QUAT_WXYZ, &in[0], &expected[0], PARALLEL_COUNT );
+	quatCobBatchParallel( caseNumber, QUAT_WXYZ, &in[0], &out[0], PARALLEL_COUNT );
+	EXPECT_TRUE( std::equal( expected.begin(), expected.begin() + PARALLEL_COUNT * 4, out.begin() ) );
+
+	matrixCob3x3Batch( caseNumber, &in[0], &expected[0], PARALLEL_COUNT );
+	matrixCob3x3BatchParallel( caseNumber, &in[0], &out[0], PARALLEL_COUNT );
+	EXPECT_TRUE( std::equal( expected.begin(), expected.end(), out.begin() ) );
+
+	// In place
+	out = in;
+	matrixCob3x3BatchParallel( caseNumber, &out[0], PARALLEL_COUNT );
+	EXPECT_TRUE( std::equal( expected.begin(), expected.end(), out.begin() ) );
+}
+
+TEST(ParallelChecks, MatchesSerial)
+{
+	for (int caseNumber = 0; caseNumber < 48; caseNumber += 7)
+	{
+		checkParallel<double>( caseNumber );
+		checkParallel<float>( caseNumber );
+	}
+}
+
+TEST(ParallelChecks, ThreadCounts)
+{
+	const unsigned int threads[] = { 1, 4, 3, 0 };
+	for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+	{
+		setParallelThreads( threads[t] );
+		if (threads[t] != 0) EXPECT_EQ( threads[t], getParallelThreads() );
+		else EXPECT_LE( 1u, getParallelThreads() );
+
+		checkParallel<float>( 37 );
+	}
+}
+
+// Small batches convert the same way on the calling thread
+TEST(ParallelChecks, Small)
+{
+	double v[9 * 5];
+	double expected[9 * 5];
+	for (int i = 0; i < 9 * 5; ++i) v[i] = expected[i] = i - 20.0;
+
+	matrixCob3x3Batch( 29, expected, 5 );
+	matrixCob3x3BatchParallel( 29, v, 5 );
+	for (int i = 0; i < 9 * 5; ++i) EXPECT_EQ( expected[i], v[i] );
+
+	vectorCobBatchParallel( 29, v, 0 );
+}
+
+struct ExecutorCounts
+{
+	size_t calls;
+	size_t tasks;
+};
+
+// Runs the tasks backwards to make sure order doesn't matter
+static void countingExecutor( void *user, size_t taskCount, ParallelTaskFn task, void *context )
+{
+	ExecutorCounts &counts = *static_cast<ExecutorCounts *>(user);
+	++counts.calls;
+	counts.tasks += taskCount;
+
+	for (size_t t = taskCount; t > 0; --t) task( context, t - 1 );
+}
+
+TEST(ParallelChecks, Executor)
+{
+	ExecutorCounts counts = { 0, 0 };
+	setParallelExecutor( countingExecutor, &counts );
+	checkParallel<double>( 13 );
+	setParallelExecutor( NULL, NULL );
+
+	EXPECT_EQ( 4u, counts.calls );
+	EXPECT_LT( 4u, counts.tasks );
+
+	// Back on the pool
+	checkParallel<double>( 13 );
+	EXPECT_EQ( 4u, counts.calls );
+}
+
+// The non-temporal store path must match the plain kernel at every length and alignment
+TEST(ParallelChecks, Stream)
+{
+	std::vector<float> in( 4096 * 3 + 64 );
+	std::vector<float> out( in.size() );
+	std::vector<float> expected( in.size() );
+	fillValues( &in[0], in.size() );
+
+	detail::LanePermutation p;
+	detail::getVectorPermutation( 22, p );
+	const detail::PermuteKernels &k = detail::getActiveKernels();
+
+	for (size_t offset = 0; offset < 8; ++offset)
+	{
+		for (size_t count = 0; count < 4096; count = count * 2 + 7)
+		{
+			std::fill( out.begin(), out.end(), 0.0f );
+			std::fill( expected.begin(), expected.end(), 0.0f );
+
+			k.permuteFloat( p, &in[0], &expected[offset], count );
+			detail::permuteBatchStream( k.permuteFloat, p, &in[0], &out[offset], count );
+			EXPECT_TRUE( std::equal( expected.begin(), expected.end(), out.begin() ) );
+		}
+	}
+}
+
+#ifdef COB_HAVE_SSE2
+// The SSE2 non-temporal copy used without AVX2 must copy every byte at every length and alignment
+TEST(ParallelChecks, StreamCopySse2)
+{
+	std::vector<unsigned char> in( 512 );
+	for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<unsigned char>((i % 255) + 1);
+
+	for (size_t offset = 0; offset < 16; ++offset)
+	{
+		for (size_t bytes = 0; bytes + offset <= in.size(); bytes = bytes * 2 + 3)
+		{
+			std::vector<unsigned char> out( in.size(), 0 );
+			detail::streamCopySse2( &out[offset], &in[0], bytes );
+			detail::streamFenceSse2();
+			EXPECT_TRUE( std::equal( in.begin(), in.begin() + bytes, out.begin() + offset ) );
+			EXPECT_EQ( static_cast<size_t>(in.size() - bytes), static_cast<size_t>(std::count( out.begin(), out.end(), 0 )) );
+		}
+	}
+}
+#endif
+
+// Buffers placed on each node, or interleaved, convert the same with NUMA on and off
+TEST(ParallelChecks, Numa)
+{
+	const size_t count = PARALLEL_COUNT;
+	const size_t bytes = count * 3 * sizeof(double);
+	std::vector<double> in( count * 3 );
+	std::vector<double> expected( count * 3 );
+	fillValues( &in[0], in.size() );
+	vectorCobBatch( 41, &in[0], &expected[0], count );
+
+	const int nodes = getParallelNumaNodes();
+	EXPECT_LE( 1, nodes );
+
+	for (int node = NUMA_INTERLEAVE; node < nodes; ++node)
+	{
+		double *src = static_cast<double *>(allocateOnNode( bytes, node ));
+		double *dst = static_cast<double *>(allocateOnNode( bytes, node ));
+		ASSERT_TRUE( src != NULL && dst != NULL );
+		std::copy( in.begin(), in.end(), src );
+
+		vectorCobBatchParallel( 41, src, dst, count );
+		EXPECT_TRUE( std::equal( expected.begin(), expected.end(), dst ) );
+
+		setParallelNuma( false );
+		EXPECT_EQ( 1, getParallelNumaNodes() );
+		vectorCobBatchParallel( 41, src, count );
+		EXPECT_TRUE( std::equal( expected.begin(), expected.end(), src ) );
+		setParallelNuma( true );
+		EXPECT_EQ( nodes, getParallelNumaNodes() );
+
+		freeOnNode( src, bytes );
+		freeOnNode( dst, bytes );
+	}
+}
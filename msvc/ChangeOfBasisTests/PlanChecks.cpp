@@ -0,0 +1,276 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisPlan.h"
+#include "BatchChecks.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cob;
+
+const triple getFrame( int index );		// FullChecks.cpp
+
+static const int PLAN_COUNT = 11;
+
+// Every element kind must match its batch function
+template <typename T>
+static void checkElements( int flags )
+{
+	T in[PLAN_COUNT * 16];
+	T out[PLAN_COUNT * 16];
+	T expected[PLAN_COUNT * 16];
+
+	fillValues( in, PLAN_COUNT * 16 );
+
+	for (int f = 0; f < 48; f += 5)
+	{
+		const triple from = getFrame( f );
+		const triple to = getFrame( (f * 7 + 3) % 48 );
+		const int caseNumber = getCaseNumber( from, to );
+
+		Plan vector( from, to, ELEMENT_VECTOR, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, 0, 0, PLAN_COUNT, flags );
+		EXPECT_TRUE( vector.isValid() );
+		EXPECT_EQ( caseNumber, vector.getCaseNumber() );
+		EXPECT_TRUE( vector.execute( in, out, PLAN_COUNT ) );
+		vectorCobBatch( caseNumber, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 3; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		Plan pseudoVector( from, to, ELEMENT_PSEUDOVECTOR, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, 0, 0, PLAN_COUNT, flags );
+		EXPECT_TRUE( pseudoVector.execute( in, out, PLAN_COUNT ) );
+		pseudoVectorCobBatch( caseNumber, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 3; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		Plan quat( from, to, ELEMENT_QUAT, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, QUAT_WXYZ, 0, PLAN_COUNT, flags );
+		EXPECT_TRUE( quat.execute( in, out, PLAN_COUNT ) );
+		quatCobBatch( caseNumber, QUAT_WXYZ, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 4; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		Plan matrix( from, to, ELEMENT_MATRIX3X3, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, 0, 0, PLAN_COUNT, flags );
+		EXPECT_TRUE( matrix.execute( in, out, PLAN_COUNT ) );
+		matrixCob3x3Batch( caseNumber, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 9; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		Plan transform( from, to, ELEMENT_MATRIX4X4, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, 0, 0, PLAN_COUNT, flags );
+		EXPECT_TRUE( transform.execute( in, out, PLAN_COUNT ) );
+		matrixCob4x4Batch( caseNumber, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 16; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		Plan transform3x4( from, to, ELEMENT_MATRIX3X4, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, MATRIX_COLUMN_MAJOR, 0, PLAN_COUNT, flags );
+		EXPECT_TRUE( transform3x4.execute( in, out, PLAN_COUNT ) );
+		matrixCob3x4Batch( caseNumber, MATRIX_COLUMN_MAJOR, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 12; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		Plan euler( from, to, ELEMENT_EULER, sizeof(T) == 8 ? SCALAR_DOUBLE : SCALAR_FLOAT, 0, 0, PLAN_COUNT, flags );
+		EXPECT_EQ( getEulerCaseNumber( from, to ), euler.getCaseNumber() );
+		EXPECT_TRUE( euler.execute( in, out, PLAN_COUNT ) );
+		eulerCobBatch( getEulerCaseNumber( from, to ), in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 3; ++i) EXPECT_EQ( expected[i], out[i] );
+	}
+}
+
+TEST(PlanChecks, Estimate)
+{
+	checkElements<double>( PLAN_ESTIMATE );
+	checkElements<float>( PLAN_ESTIMATE );
+}
+
+TEST(PlanChecks, Measure)
+{
+	forgetWisdom();
+	checkElements<double>( PLAN_MEASURE );
+	checkElements<float>( PLAN_MEASURE );
+	forgetWisdom();
+}
+
+// Below the parallel minimum the parallel kernel runs on one thread, so there is nothing to time
+TEST(PlanChecks, MeasureSmall)
+{
+	forgetWisdom();
+	const size_t count = detail::PARALLEL_MIN_BYTES / (9 * sizeof(double)) - 1;
+	Plan plan( BvhFrame, OpenGLFrame, ELEMENT_MATRIX3X3, SCALAR_DOUBLE, 0, 0, count, PLAN_MEASURE );
+	EXPECT_TRUE( plan.isValid() );
+	EXPECT_FALSE( plan.isParallel() );
+	forgetWisdom();
+}
+
+// Values past the end of each element are copied through
+TEST(PlanChecks, Stride)
+{
+	const int stride = 5;
+	int16_t in[PLAN_COUNT * stride];
+	int16_t out[PLAN_COUNT * stride];
+	int16_t expected[3];
+
+	for (int i = 0; i < PLAN_COUNT * stride; ++i) in[i] = static_cast<int16_t>(i * 101 - 700);
+
+	Plan plan( PrioVRFrame, Unreal3Frame, ELEMENT_VECTOR, SCALAR_INT16, 0, stride, PLAN_COUNT );
+	EXPECT_TRUE( plan.isValid() );
+	EXPECT_TRUE( plan.execute( in, out, PLAN_COUNT ) );
+
+	for (int n = 0; n < PLAN_COUNT; ++n)
+	{
+		vectorCobBatch( plan.getCaseNumber(), in + n * stride, expected, 1 );
+		for (int c = 0; c < 3; ++c) EXPECT_EQ( expected[c], out[n * stride + c] );
+		for (int c = 3; c < stride; ++c) EXPECT_EQ( in[n * stride + c], out[n * stride + c] );
+	}
+}
+
+TEST(PlanChecks, Invalid)
+{
+	EXPECT_FALSE( Plan().isValid() );
+	EXPECT_FALSE( Plan( PrioVRFrame, Unreal3Frame, ELEMENT_COUNT, SCALAR_FLOAT, 0, 0, 10 ).isValid() );
+	EXPECT_FALSE( Plan( PrioVRFrame, Unreal3Frame, ELEMENT_VECTOR, SCALAR_COUNT, 0, 0, 10 ).isValid() );
+	EXPECT_FALSE( Plan( PrioVRFrame, Unreal3Frame, ELEMENT_QUAT, SCALAR_FLOAT, 2, 0, 10 ).isValid() );
+	EXPECT_FALSE( Plan( PrioVRFrame, Unreal3Frame, ELEMENT_MATRIX3X3, SCALAR_FLOAT, 0, 8, 10 ).isValid() );
+	EXPECT_FALSE( Plan( PrioVRFrame, Unreal3Frame, ELEMENT_VECTOR, SCALAR_FLOAT, 0, PLAN_MAX_STRIDE + 1, 10 ).isValid() );
+
+	// The wrong scalar type does nothing
+	Plan plan( PrioVRFrame, Unreal3Frame, ELEMENT_VECTOR, SCALAR_FLOAT, 0, 0, 10, PLAN_ESTIMATE );
+	double v[3] = { 1.0, 2.0, 3.0 };
+	EXPECT_FALSE( plan.execute( v, v, 1 ) );
+	EXPECT_EQ( 1.0, v[0] );
+	EXPECT_EQ( 2.0, v[1] );
+	EXPECT_EQ( 3.0, v[2] );
+}
+
+// cobCopy must match the batch functions, in place too, and reject what a Plan rejects
+TEST(PlanChecks, Copy)
+{
+	float in[PLAN_COUNT * 12];
+	float out[PLAN_COUNT * 12];
+	float expected[PLAN_COUNT * 12];
+	fillValues( in, PLAN_COUNT * 12 );
+
+	for (int caseNumber = 0; caseNumber < 48; caseNumber += 5)
+	{
+		EXPECT_TRUE( cobCopy( ELEMENT_VECTOR, 0, caseNumber, in, out, PLAN_COUNT ) );
+		vectorCobBatch( caseNumber, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 3; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		EXPECT_TRUE( cobCopy( ELEMENT_QUAT, QUAT_XYZW, caseNumber, in, out, PLAN_COUNT, COPY_DEVICE_SOURCE ) );
+		quatCobBatch( caseNumber, QUAT_XYZW, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 4; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		EXPECT_TRUE( cobCopy( ELEMENT_MATRIX3X4, MATRIX_ROW_MAJOR, caseNumber, in, out, PLAN_COUNT ) );
+		matrixCob3x4Batch( caseNumber, MATRIX_ROW_MAJOR, in, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 12; ++i) EXPECT_EQ( expected[i], out[i] );
+
+		EXPECT_TRUE( cobCopy( ELEMENT_MATRIX3X4, MATRIX_ROW_MAJOR, caseNumber, out, out, PLAN_COUNT ) );
+		matrixCob3x4Batch( caseNumber, MATRIX_ROW_MAJOR, expected, PLAN_COUNT );
+		for (int i = 0; i < PLAN_COUNT * 12; ++i) EXPECT_EQ( expected[i], out[i] );
+	}
+
+	EXPECT_FALSE( cobCopy( ELEMENT_COUNT, 0, 5, in, out, PLAN_COUNT ) );
+	EXPECT_FALSE( cobCopy( ELEMENT_QUAT, 2, 5, in, out, PLAN_COUNT ) );
+}
+
+// The streaming load path, with and without streaming stores, must match the plain kernel at every length and alignment
+TEST(PlanChecks, CopyStream)
+{
+	std::vector<double> in( 2048 * 9 + 64 );
+	std::vector<double> out( in.size() );
+	std::vector<double> expected( in.size() );
+	fillValues( &in[0], in.size() );
+
+	detail::LanePermutation p;
+	detail::getMatrixPermutation( 33, p );
+	const detail::PermuteKernels &k = detail::getActiveKernels();
+
+	for (size_t offset = 0; offset < 6; ++offset)
+	{
+		for (size_t count = 0; count < 2048; count = count * 2 + 5)
+		{
+			std::fill( expected.begin(), expected.end(), 0.0 );
+			k.permuteDouble( p, &in[offset], &expected[5 - offset], count );
+
+			for (int streamStores = 0; streamStores < 2; ++streamStores)
+			{
+				std::fill( out.begin(), out.end(), 0.0 );
+				detail::permuteStreamLoad( k.permuteDouble, p, &in[offset], &out[5 - offset], count, streamStores != 0 );
+				EXPECT_TRUE( std::equal( expected.begin(), expected.end(), out.begin() ) );
+			}
+		}
+	}
+}
+
+// Measured choices saved to a file are used by later plans without measuring
+TEST(PlanChecks, Wisdom)
+{
+	const char *path = "cobWisdomTest.txt";
+
+	forgetWisdom();
+	Plan measured( BvhFrame, OpenGLFrame, ELEMENT_MATRIX3X3, SCALAR_DOUBLE, 0, 0, 5000, PLAN_MEASURE );
+	EXPECT_TRUE( measured.isValid() );
+	EXPECT_LE( measured.getSimdLevel(), SIMD_AVX512 );
+	EXPECT_TRUE( exportWisdom( path ) );
+
+	// The answer was remembered so it can be told apart from the estimate
+	forgetWisdom();
+	EXPECT_TRUE( importWisdom( path ) );
+	Plan estimated( KinectFrame, OculusFrame, ELEMENT_MATRIX3X3, SCALAR_DOUBLE, 0, 0, 5000, PLAN_ESTIMATE );
+	EXPECT_EQ( measured.getSimdLevel(), estimated.getSimdLevel() );
+	EXPECT_EQ( measured.isParallel(), estimated.isParallel() );
+
+	// A parallel answer isn't used by a plan that has to stay on one thread
+	Plan oneThread( KinectFrame, OculusFrame, ELEMENT_MATRIX3X3, SCALAR_DOUBLE, 0, 0, 5000, PLAN_ESTIMATE | PLAN_ONE_THREAD );
+	EXPECT_FALSE( oneThread.isParallel() );
+
+	forgetWisdom();
+	std::remove( path );
+
+	// A plan measured on one thread keeps its own wisdom and leaves the all threads answer
+	// alone, also when that came from a version 2 file
+	FILE *old = std::fopen( path, "w" );
+	ASSERT_TRUE( old != NULL );
+	std::fputs( "cob-wisdom 2\n0 3 21 1 1\n", old );
+	std::fclose( old );
+	EXPECT_TRUE( importWisdom( path ) );
+
+	const size_t count = 90000;		// 2 MB of double vectors, size bucket 21
+	Plan single( KinectFrame, OculusFrame, ELEMENT_VECTOR, SCALAR_DOUBLE, 0, 0, count, PLAN_MEASURE | PLAN_ONE_THREAD );
+	EXPECT_FALSE( single.isParallel() );
+	Plan shared( KinectFrame, OculusFrame, ELEMENT_VECTOR, SCALAR_DOUBLE, 0, 0, count, PLAN_ESTIMATE );
+	EXPECT_TRUE( shared.isParallel() );
+
+	EXPECT_TRUE( exportWisdom( path ) );
+	std::ifstream saved( path );
+	std::string line;
+	std::vector<std::string> lines;
+	while (std::getline( saved, line )) lines.push_back( line );
+	saved.close();
+	ASSERT_EQ( 3u, lines.size() );
+	EXPECT_EQ( "cob-wisdom 3", lines[0] );
+	EXPECT_EQ( "0 3 21 0 1 1", lines[1] );
+	EXPECT_EQ( "0 3 21 1 ", lines[2].substr( 0, 9 ) );
+	EXPECT_EQ( " 0", lines[2].substr( lines[2].size() - 2 ) );
+
+	forgetWisdom();
+	std::remove( path );
+
+	EXPECT_FALSE( importWisdom( path ) );
+
+	FILE *bad = std::fopen( path, "w" );
+	ASSERT_TRUE( bad != NULL );
+	std::fputs( "not wisdom\n", bad );
+	std::fclose( bad );
+	EXPECT_FALSE( importWisdom( path ) );
+	std::remove( path );
+}
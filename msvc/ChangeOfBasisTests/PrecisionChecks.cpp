@@ -0,0 +1,101 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasis.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+// The float versions must give exactly the double answer, since only signs and order change.
+TEST(PrecisionChecks, Float)
+{
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		double v[3] = { 1.5, -2.5, 3.5 };
+		float f[3] = { 1.5f, -2.5f, 3.5f };
+		vectorCob( caseNumber, v[0], v[1], v[2] );
+		vectorCob( caseNumber, f[0], f[1], f[2] );
+		for (int i = 0; i < 3; ++i) EXPECT_EQ( float(v[i]), f[i] );
+
+		double q[4] = { 0.1, -0.2, 0.3, 0.9 };
+		float g[4] = { 0.1f, -0.2f, 0.3f, 0.9f };
+		quatCob( caseNumber, q[0], q[1], q[2], q[3] );
+		quatCob( caseNumber, g[0], g[1], g[2], g[3] );
+		for (int i = 0; i < 4; ++i) EXPECT_EQ( float(q[i]), g[i] );
+
+		double m[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		float n[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		matrixCob3x3( caseNumber, m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8] );
+		matrixCob3x3( caseNumber, n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], n[8] );
+		for (int i = 0; i < 9; ++i) EXPECT_EQ( float(m[i]), n[i] );
+	}
+
+	for (int eulerCaseNumber = 0; eulerCaseNumber < 8; ++eulerCaseNumber)
+	{
+		double e[3] = { 10.0, 20.0, 30.0 };
+		float h[3] = { 10.0f, 20.0f, 30.0f };
+		eulerCob( eulerCaseNumber, e[0], e[1], e[2] );
+		eulerCob( eulerCaseNumber, h[0], h[1], h[2] );
+		for (int i = 0; i < 3; ++i) EXPECT_EQ( float(e[i]), h[i] );
+	}
+}
+
+// Half floats are only bits to the change of basis.  These are 1.0, -2.0, 3.0, ... as halves.
+static const uint16_t halfValues[9] = { 0x3C00, 0xC000, 0x4200, 0xC400, 0x4500, 0xC600, 0x4700, 0xC800, 0x4880 };
+
+static uint16_t toHalf( float f )
+{
+	for (int i = 0; i < 9; ++i)
+	{
+		if (float(i + 1) == f) return static_cast<uint16_t>(halfValues[i] & 0x7FFF);
+		if (-float(i + 1) == f) return static_cast<uint16_t>(halfValues[i] | 0x8000);
+	}
+	return 0xFFFF;
+}
+
+TEST(PrecisionChecks, Half)
+{
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		float f[9] = { 1, -2, 3, -4, 5, -6, 7, -8, 9 };
+		uint16_t h[9];
+		for (int i = 0; i < 9; ++i) h[i] = halfValues[i];
+
+		vectorCob( caseNumber, f[0], f[1], f[2] );
+		vectorCobHalf( caseNumber, h[0], h[1], h[2] );
+		for (int i = 0; i < 3; ++i) EXPECT_EQ( toHalf( f[i] ), h[i] );
+
+		quatCob( caseNumber, f[3], f[4], f[5], f[6] );
+		quatCobHalf( caseNumber, h[3], h[4], h[5], h[6] );
+		for (int i = 3; i < 7; ++i) EXPECT_EQ( toHalf( f[i] ), h[i] );
+
+		float m[9] = { 1, -2, 3, -4, 5, -6, 7, -8, 9 };
+		uint16_t n[9];
+		for (int i = 0; i < 9; ++i) n[i] = halfValues[i];
+		matrixCob3x3( caseNumber, m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8] );
+		matrixCob3x3Half( caseNumber, n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], n[8] );
+		for (int i = 0; i < 9; ++i) EXPECT_EQ( toHalf( m[i] ), n[i] );
+	}
+
+	for (int eulerCaseNumber = 0; eulerCaseNumber < 8; ++eulerCaseNumber)
+	{
+		float e[3] = { 1, -2, 3 };
+		uint16_t h[3] = { halfValues[0], halfValues[1], halfValues[2] };
+		eulerCob( eulerCaseNumber, e[0], e[1], e[2] );
+		eulerCobHalf( eulerCaseNumber, h[0], h[1], h[2] );
+		for (int i = 0; i < 3; ++i) EXPECT_EQ( toHalf( e[i] ), h[i] );
+	}
+}
@@ -0,0 +1,106 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasisStatic.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+const triple getFrame( int index );		// FullChecks.cpp
+
+static_assert( getCaseNumber< KinectFrameType, OpenGLFrameType >() == 5, "case number is computed at compile time" );
+
+// The compile time case number must match getCaseNumber() for every pair of frames.
+TEST(StaticChecks, CaseNumber)
+{
+	for (int i = 0; i < 48; ++i)
+	{
+		for (int j = 0; j < 48; ++j)
+		{
+			EXPECT_EQ( getCaseNumber( getFrame(i), getFrame(j) ), detail::caseNumber( getFrame(i), getFrame(j) ) );
+		}
+	}
+}
+
+// Instantiates the straight line code for every case and compares it to the runtime functions.
+template <int Case>
+static void checkCase()
+{
+	double vx(1.5), vy(-2.5), vz(3.5);
+	double rx(vx), ry(vy), rz(vz);
+	detail::CaseCob<Case>::vector( vx, vy, vz );
+	vectorCob( Case, rx, ry, rz );
+	EXPECT_EQ( rx, vx );
+	EXPECT_EQ( ry, vy );
+	EXPECT_EQ( rz, vz );
+
+	double qx(0.1), qy(-0.2), qz(0.3), qw(0.9);
+	double sx(qx), sy(qy), sz(qz), sw(qw);
+	detail::CaseCob<Case>::quat( qx, qy, qz );
+	quatCob( Case, sx, sy, sz, sw );
+	EXPECT_EQ( sx, qx );
+	EXPECT_EQ( sy, qy );
+	EXPECT_EQ( sz, qz );
+
+	double px(1.5), py(-2.5), pz(3.5);
+	double ux(px), uy(py), uz(pz);
+	detail::CaseCob<Case>::pseudoVector( px, py, pz );
+	pseudoVectorCob( Case, ux, uy, uz );
+	EXPECT_EQ( ux, px );
+	EXPECT_EQ( uy, py );
+	EXPECT_EQ( uz, pz );
+
+	double m[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	double r[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	detail::CaseCob<Case>::matrix( m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8] );
+	matrixCob3x3( Case, r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8] );
+	for (int i = 0; i < 9; ++i)
+	{
+		EXPECT_EQ( r[i], m[i] );
+	}
+
+	checkCase<Case + 1>();
+}
+
+template <>
+void checkCase<48>()
+{
+}
+
+TEST(StaticChecks, EveryCase)
+{
+	checkCase<0>();
+}
+
+TEST(StaticChecks, PrioVRToUnreal)
+{
+	float qx(0.1f), qy(0.2f), qz(0.3f), qw(0.927f);
+	double rx(qx), ry(qy), rz(qz), rw(qw);
+
+	quatCob< PrioVRFrameType, Unreal3FrameType >( qx, qy, qz, qw );
+	quatCob( getCaseNumber( PrioVRFrame, Unreal3Frame ), rx, ry, rz, rw );
+
+	EXPECT_EQ( float(rx), qx );
+	EXPECT_EQ( float(ry), qy );
+	EXPECT_EQ( float(rz), qz );
+	EXPECT_EQ( float(rw), qw );
+
+	double x(1.0), y(2.0), z(3.0);
+	vectorCob< OculusFrameType, OculusFrameType >( x, y, z );
+	EXPECT_EQ( 1.0, x );
+	EXPECT_EQ( 2.0, y );
+	EXPECT_EQ( 3.0, z );
+}
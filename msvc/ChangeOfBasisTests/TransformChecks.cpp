@@ -0,0 +1,201 @@
+//Copyright 2014 Scott M. Johnson
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "changeOfBasis.h"
+#include "BatchChecks.h"
+#pragma warning (push, 3)
+#include "gtest\gtest.h"
+#pragma warning(pop)
+
+using namespace cob;
+
+static const int TRANSFORM_COUNT = 5;
+
+// [ P ] . [ MA ] . transpose([ P ]) done the long way with P = [ MAtoB 0 ; 0 1 ]
+static void fullMath4x4( int caseNumber, const double *a, double *b )
+{
+	double p[4][4] = {};
+	getAtoBMatrix( caseNumber,
+		p[0][0], p[0][1], p[0][2],
+		p[1][0], p[1][1], p[1][2],
+		p[2][0], p[2][1], p[2][2] );
+	p[3][3] = 1.0;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			double sum = 0.0;
+			for (int k = 0; k < 4; ++k)
+			{
+				for (int l = 0; l < 4; ++l)
+				{
+					sum += p[i][k] * a[k * 4 + l] * p[j][l];
+				}
+			}
+			b[i * 4 + j] = sum;
+		}
+	}
+}
+
+TEST(TransformChecks, AgainstFullMath)
+{
+	double a[16];
+	fillValues( a, 16 );
+	a[12] = a[13] = a[14] = 0.0;
+	a[15] = 1.0;
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		double expected[16];
+		fullMath4x4( caseNumber, a, expected );
+
+		double m[16];
+		for (int k = 0; k < 16; ++k) m[k] = a[k];
+		matrixCob4x4( caseNumber, m );
+
+		for (int k = 0; k < 16; ++k)
+		{
+			EXPECT_EQ( expected[k], m[k] );
+		}
+	}
+}
+
+// The rotation block must match matrixCob3x3 and the translation vectorCob
+TEST(TransformChecks, RotationAndTranslation)
+{
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		float m[16];
+		fillValues( m, 16 );
+		const float bottom[4] = { m[12], m[13], m[14], m[15] };
+
+		float r[9] = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+		float t[3] = { m[3], m[7], m[11] };
+		matrixCob3x3( caseNumber, r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8] );
+		vectorCob( caseNumber, t[0], t[1], t[2] );
+
+		matrixCob4x4( caseNumber, m );
+
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				EXPECT_EQ( r[i * 3 + j], m[i * 4 + j] );
+			}
+			EXPECT_EQ( t[i], m[i * 4 + 3] );
+		}
+
+		// The corner never moves or changes sign
+		EXPECT_EQ( bottom[3], m[15] );
+	}
+}
+
+// Both 3x4 layouts must match the top three rows of the 4x4
+TEST(TransformChecks, ThreeByFour)
+{
+	double m4[16];
+	fillValues( m4, 16 );
+	m4[12] = m4[13] = m4[14] = 0.0;
+	m4[15] = 1.0;
+
+	double rowMajor[12];
+	double columnMajor[12];
+	for (int r = 0; r < 3; ++r)
+	{
+		for (int c = 0; c < 4; ++c)
+		{
+			rowMajor[r * 4 + c] = m4[r * 4 + c];
+			columnMajor[c * 3 + r] = m4[r * 4 + c];
+		}
+	}
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		double expected[16];
+		for (int k = 0; k < 16; ++k) expected[k] = m4[k];
+		matrixCob4x4( caseNumber, expected );
+
+		double a[12], b[12];
+		for (int k = 0; k < 12; ++k)
+		{
+			a[k] = rowMajor[k];
+			b[k] = columnMajor[k];
+		}
+		matrixCob3x4( caseNumber, MATRIX_ROW_MAJOR, a );
+		matrixCob3x4( caseNumber, MATRIX_COLUMN_MAJOR, b );
+
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				EXPECT_EQ( expected[r * 4 + c], a[r * 4 + c] );
+				EXPECT_EQ( expected[r * 4 + c], b[c * 3 + r] );
+			}
+		}
+	}
+}
+
+template <typename T>
+static void checkTransformBatch()
+{
+	T in[TRANSFORM_COUNT * 16];
+	T out[TRANSFORM_COUNT * 16];
+	T inPlace[TRANSFORM_COUNT * 16];
+	T e[16];
+
+	fillValues( in, TRANSFORM_COUNT * 16 );
+
+	for (int caseNumber = 0; caseNumber < 48; ++caseNumber)
+	{
+		matrixCob4x4Batch( caseNumber, in, out, TRANSFORM_COUNT );
+		for (int i = 0; i < TRANSFORM_COUNT * 16; ++i) inPlace[i] = in[i];
+		matrixCob4x4Batch( caseNumber, inPlace, TRANSFORM_COUNT );
+
+		for (int n = 0; n < TRANSFORM_COUNT; ++n)
+		{
+			for (int k = 0; k < 16; ++k) e[k] = in[n * 16 + k];
+			matrixCob4x4( caseNumber, e );
+			for (int k = 0; k < 16; ++k)
+			{
+				EXPECT_EQ( e[k], out[n * 16 + k] );
+				EXPECT_EQ( e[k], inPlace[n * 16 + k] );
+			}
+		}
+
+		for (int layout = MATRIX_ROW_MAJOR; layout <= MATRIX_COLUMN_MAJOR; ++layout)
+		{
+			matrixCob3x4Batch( caseNumber, layout, in, out, TRANSFORM_COUNT );
+			for (int i = 0; i < TRANSFORM_COUNT * 12; ++i) inPlace[i] = in[i];
+			matrixCob3x4Batch( caseNumber, layout, inPlace, TRANSFORM_COUNT );
+
+			for (int n = 0; n < TRANSFORM_COUNT; ++n)
+			{
+				for (int k = 0; k < 12; ++k) e[k] = in[n * 12 + k];
+				matrixCob3x4( caseNumber, layout, e );
+				for (int k = 0; k < 12; ++k)
+				{
+					EXPECT_EQ( e[k], out[n * 12 + k] );
+					EXPECT_EQ( e[k], inPlace[n * 12 + k] );
+				}
+			}
+		}
+	}
+}
+
+TEST(TransformChecks, Batch)
+{
+	forEachSimdLevel( checkTransformBatch<double> );
+	forEachSimdLevel( checkTransformBatch<float> );
+}